@@ -0,0 +1,105 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <algorithm>
+#include <limits>
+#include "perf_counters.hpp"
+
+namespace disjoint_interval_set::bench {
+  /**
+   * The result of a benchmarked operation: the best wall-clock time over
+   * the repetitions, the amount of work one repetition does, and the
+   * hardware counters of the best repetition when counting is enabled.
+   */
+  struct measurement {
+    std::string name;
+    double seconds;
+    std::size_t bytes;
+    std::size_t items;
+    perf_values counters;
+  };
+
+  /**
+   * The counters shared by all benchmarks, or nullptr unless the
+   * environment variable BENCH_PERF is set.
+   */
+  inline perf_counters * counters() {
+    static bool const enabled = std::getenv("BENCH_PERF") != nullptr;
+    if (!enabled) return nullptr;
+    static perf_counters c;
+    return &c;
+  }
+
+  /**
+   * Prevents the optimizer from discarding a value that is otherwise unused.
+   */
+  template <typename T>
+  inline void do_not_optimize(T const & value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+  }
+
+  /**
+   * Runs op reps times and keeps the fastest run, which is the one least
+   * disturbed by the scheduler and cold caches.
+   *
+   * @param name A label for the report.
+   * @param reps The number of repetitions.
+   * @param bytes The number of input bytes one run processes, or 0.
+   * @param items The number of intervals one run processes.
+   * @param op The operation to benchmark.
+   */
+  template <typename Op>
+  measurement run(std::string name, int reps, std::size_t bytes,
+                  std::size_t items, Op op) {
+    using clock = std::chrono::steady_clock;
+    double best = std::numeric_limits<double>::infinity();
+    perf_values best_counters;
+    best_counters.fill(-1);
+    auto * const pc = counters();
+    for (int i = 0; i < reps; ++i) {
+      if (pc) pc->start();
+      auto const start = clock::now();
+      op();
+      std::chrono::duration<double> const elapsed = clock::now() - start;
+      auto const values = pc ? pc->stop() : best_counters;
+      if (elapsed.count() < best) {
+        best = elapsed.count();
+        best_counters = values;
+      }
+    }
+    return measurement{std::move(name), best, bytes, items, best_counters};
+  }
+
+  /**
+   * Prints the header for report().
+   */
+  inline void report_header() {
+    std::printf("%-32s %14s %12s %12s %16s\n",
+                "benchmark", "bytes", "seconds", "MB/s", "intervals/s");
+  }
+
+  /**
+   * Prints one measurement as a row of throughput figures, followed by a
+   * row of hardware events per interval if they were counted.
+   */
+  inline void report(measurement const & m) {
+    std::printf("%-32s %14zu %12.6f %12.2f %16.0f\n",
+                m.name.c_str(), m.bytes, m.seconds,
+                m.bytes / m.seconds / 1e6, m.items / m.seconds);
+
+    if (!counters()) return;
+    std::printf("  per interval:");
+    for (std::size_t i = 0; i < perf_event_count; ++i) {
+      if (m.counters[i] < 0)
+        std::printf(" %s=n/a", perf_event_names[i]);
+      else
+        std::printf(" %s=%.3f", perf_event_names[i],
+                    static_cast<double>(m.counters[i]) / std::max<std::size_t>(m.items, 1));
+    }
+    std::printf("\n");
+  }
+}
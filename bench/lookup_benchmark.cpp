@@ -0,0 +1,100 @@
+/**
+ * Point lookups per second on large sets, by binary search, by the
+ * learned index and by interleaved batch searches, with the set in
+ * regular and in huge pages.
+ *
+ *   g++ -std=c++20 -O2 -Iinclude bench/lookup_benchmark.cpp -o lookup_benchmark
+ *   ./lookup_benchmark [max-intervals] [queries]
+ *
+ * Set BENCH_PERF=1 to also report hardware counters per lookup (Linux);
+ * the dTLB misses show what huge pages save.
+ *
+ * Sets grow by a factor of four from 1K up to max-intervals (default
+ * 16M) and are probed with queries random points (default 4M). Their
+ * left endpoints grow almost linearly, as timestamps do.
+ */
+
+#include <disjoint_interval_set/disjoint_interval_set_algorithms.hpp>
+#include <disjoint_interval_set/disjoint_interval_set_allocator.hpp>
+#include <disjoint_interval_set/disjoint_interval_set_batch.hpp>
+#include <disjoint_interval_set/interval.hpp>
+#include <disjoint_interval_set/learned_index.hpp>
+#include "benchmark.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace disjoint_interval_set;
+
+namespace {
+  template <typename Alloc = std::allocator<interval<double>>>
+  std::vector<interval<double>, Alloc> make_set(std::size_t n, unsigned seed = 42) {
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> gap(0.5, 1.5), width(0.0, 1.0);
+    std::vector<interval<double>, Alloc> s;
+    s.reserve(n);
+    double x = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+      x += gap(rng);
+      auto const w = width(rng);
+      s.emplace_back(x, x + w, false, false);
+      x += w;
+    }
+    return s;
+  }
+
+  template <typename Lookup>
+  void measure(std::string name, std::vector<double> const & queries, Lookup lookup) {
+    bench::report(bench::run(std::move(name), 3, 0, queries.size(), [&] {
+      std::size_t hits = 0;
+      for (auto const q : queries) hits += lookup(q);
+      bench::do_not_optimize(hits);
+    }));
+  }
+}
+
+int main(int argc, char ** argv) {
+  std::size_t const max_intervals =
+    argc > 1 ? std::strtoull(argv[1], nullptr, 10) : std::size_t(16) << 20;
+  std::size_t const count =
+    argc > 2 ? std::strtoull(argv[2], nullptr, 10) : std::size_t(4) << 20;
+
+  bench::report_header();
+  for (std::size_t n = 1024; n <= max_intervals; n *= 4) {
+    auto const s = make_set(n);
+    std::mt19937_64 rng(7);
+    std::uniform_real_distribution<double> point(0.0, s.back().right);
+    std::vector<double> queries(count);
+    for (auto & q : queries) q = point(rng);
+
+    auto const tag = " n=" + std::to_string(n);
+    measure("binary_search" + tag, queries, [&](double q) {
+      return detail::sorted_contains(s.begin(), s.end(), q);
+    });
+
+    bench::report(bench::run("batch_contains G=8" + tag, 3, 0, queries.size(), [&] {
+      bench::do_not_optimize(batch_contains<8>(s, queries).data());
+    }));
+    bench::report(bench::run("batch_contains G=16" + tag, 3, 0, queries.size(), [&] {
+      bench::do_not_optimize(batch_contains<16>(s, queries).data());
+    }));
+
+    auto const h = make_set<huge_page_allocator<interval<double>>>(n);
+    measure("binary_search huge" + tag, queries, [&](double q) {
+      return detail::sorted_contains(h.begin(), h.end(), q);
+    });
+    bench::report(bench::run("batch_contains huge G=16" + tag, 3, 0, queries.size(), [&] {
+      bench::do_not_optimize(batch_contains<16>(h, queries).data());
+    }));
+
+    for (std::size_t eps : {16, 64, 256}) {
+      learned_index<interval<double>> const li(s, eps);
+      measure("learned eps=" + std::to_string(eps) + tag, queries,
+              [&](double q) { return li.contains(q); });
+      std::printf("  index bytes: %zu\n", li.memory_usage().heap_bytes);
+    }
+  }
+}
@@ -0,0 +1,128 @@
+/**
+ * Throughput of the interval set parsers in MB/s and intervals/s.
+ *
+ *   g++ -std=c++20 -O2 -Iinclude bench/parser_benchmark.cpp -o parser_benchmark
+ *   ./parser_benchmark [max-bytes] [regex-max-bytes]
+ *
+ * Set BENCH_PERF=1 to also report hardware counters per interval (Linux).
+ *
+ * Corpora grow by a factor of four from 1 KB up to max-bytes
+ * (default 64 MB, pass 1073741824 for 1 GB). The regex parser is much
+ * slower, so it only runs on corpora up to regex-max-bytes (default 16 MB).
+ */
+
+#include <disjoint_interval_set/disjoint_interval_set_parser.hpp>
+#include <disjoint_interval_set/interval.hpp>
+#include "benchmark.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace disjoint_interval_set;
+
+namespace {
+  struct interval_list : std::vector<interval<double>> {
+    using interval_type = interval<double>;
+  };
+
+  // appends a number in one of the notations the parsers accept
+  void append_number(std::string & out, double x, std::mt19937_64 & rng) {
+    char buf[64];
+    switch (rng() % 4) {
+      case 0: std::snprintf(buf, sizeof buf, "%.0f", x); break;
+      case 1: std::snprintf(buf, sizeof buf, "%.3f", x); break;
+      case 2: std::snprintf(buf, sizeof buf, "%.4e", x); break;
+      default: std::snprintf(buf, sizeof buf, "%.6g", x); break;
+    }
+    out += buf;
+  }
+
+  void append_spaces(std::string & out, std::mt19937_64 & rng) {
+    for (auto n = rng() % 3; n != 0; --n)
+      out += ' ';
+  }
+
+  /**
+   * Generates a corpus of about the given size with a realistic mix of
+   * closed, open and half-open intervals, singletons, scientific notation,
+   * infinite endpoints and irregular whitespace.
+   */
+  std::string make_corpus(std::size_t bytes, unsigned seed = 42) {
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> width(0.0, 100.0);
+    std::string out;
+    out.reserve(bytes + 64);
+    double x = -1e6;
+
+    while (out.size() < bytes) {
+      auto const kind = rng() % 16;
+      if (kind == 0) {
+        append_number(out, x, rng);
+      } else {
+        out += (rng() & 1) ? '[' : '(';
+        append_spaces(out, rng);
+        if (kind == 1)
+          out += (rng() & 1) ? "-inf" : "-infinity";
+        else
+          append_number(out, x, rng);
+        append_spaces(out, rng);
+        out += ',';
+        append_spaces(out, rng);
+        x += width(rng);
+        if (kind == 2)
+          out += (rng() & 1) ? "inf" : "+infinity";
+        else
+          append_number(out, x, rng);
+        append_spaces(out, rng);
+        out += (rng() & 1) ? ']' : ')';
+      }
+      x += width(rng);
+      out += (rng() % 8 == 0) ? "\n" : (rng() & 1) ? " " : ", ";
+    }
+    return out;
+  }
+
+  template <typename Parser>
+  bench::measurement measure(char const * name, std::string const & corpus,
+                             Parser parse) {
+    interval_list probe;
+    parse(corpus, probe);
+    auto const items = probe.size();
+    int const reps = corpus.size() < (1u << 20) ? 20 : 3;
+
+    return bench::run(name, reps, corpus.size(), items, [&] {
+      interval_list is;
+      is.reserve(items);
+      parse(corpus, is);
+      bench::do_not_optimize(is.data());
+    });
+  }
+}
+
+int main(int argc, char ** argv) {
+  std::size_t const max_bytes =
+    argc > 1 ? std::strtoull(argv[1], nullptr, 10) : std::size_t(64) << 20;
+  std::size_t const regex_max_bytes =
+    argc > 2 ? std::strtoull(argv[2], nullptr, 10) : std::size_t(16) << 20;
+
+  bench::report_header();
+  for (std::size_t bytes = 1024; bytes <= max_bytes; bytes *= 4) {
+    auto const corpus = make_corpus(bytes);
+
+    auto const fast = measure("make_interval_set_fast", corpus,
+      [](string_view s, interval_list & is) { make_interval_set_fast(s, is); });
+    bench::report(fast);
+
+    if (bytes <= regex_max_bytes) {
+      auto const slow = measure("make_interval_set", corpus,
+        [](string_view s, interval_list & is) { make_interval_set(s, is); });
+      bench::report(slow);
+      if (slow.items != fast.items)
+        std::printf("warning: parsers disagree (%zu vs %zu intervals)\n",
+                    slow.items, fast.items);
+    }
+  }
+}
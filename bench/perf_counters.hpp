@@ -0,0 +1,161 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace disjoint_interval_set::bench {
+  /**
+   * The hardware events the harness can count.
+   */
+  enum class perf_event {
+    cycles,
+    instructions,
+    l1d_misses,
+    llc_misses,
+    branch_misses,
+    dtlb_misses
+  };
+
+  inline constexpr std::size_t perf_event_count = 6;
+
+  inline constexpr std::array<char const *, perf_event_count> perf_event_names = {
+    "cycles", "instructions", "L1d-load-misses", "LLC-load-misses", "branch-misses",
+    "dTLB-load-misses"
+  };
+
+  /**
+   * Counter values for one measured region; an event the machine or the
+   * kernel does not expose reads as -1.
+   */
+  using perf_values = std::array<std::int64_t, perf_event_count>;
+
+  /**
+   * A group of hardware performance counters read with perf_event_open,
+   * counting user-space events of the calling thread. All events are
+   * scheduled together, so their values describe the same instructions.
+   * When the kernel multiplexes the group with others, the values are
+   * scaled up by the ratio of time enabled to time running; a group that
+   * never ran reads as -1.
+   *
+   * On other platforms, or when the kernel refuses the counters (e.g.
+   * kernel.perf_event_paranoid is too strict), available() is false and
+   * every value reads as -1.
+   */
+  class perf_counters {
+  public:
+    perf_counters() {
+      fds_.fill(-1);
+#ifdef __linux__
+      for (std::size_t i = 0; i < perf_event_count; ++i)
+        fds_[i] = open(static_cast<perf_event>(i), fds_[0]);
+#endif
+    }
+
+    perf_counters(perf_counters const &) = delete;
+    perf_counters & operator=(perf_counters const &) = delete;
+
+    ~perf_counters() {
+#ifdef __linux__
+      for (auto fd : fds_)
+        if (fd != -1) close(fd);
+#endif
+    }
+
+    bool available() const { return fds_[0] != -1; }
+
+    void start() {
+#ifdef __linux__
+      if (!available()) return;
+      ioctl(fds_[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+      ioctl(fds_[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+    }
+
+    perf_values stop() {
+      perf_values v;
+      v.fill(-1);
+#ifdef __linux__
+      if (!available()) return v;
+      ioctl(fds_[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+      // the number of events, the time enabled and running, then one value
+      // per open event
+      std::uint64_t buf[3 + perf_event_count];
+      if (read(fds_[0], buf, sizeof buf) < static_cast<ssize_t>(3 * sizeof(std::uint64_t)))
+        return v;
+      auto const enabled = buf[1], running = buf[2];
+      // never on a counter: nothing was measured
+      if (running == 0)
+        return v;
+      // multiplexed with other groups: extrapolate to the whole time enabled
+      auto const scale = running < enabled ?
+        static_cast<double>(enabled) / static_cast<double>(running) : 1.0;
+      std::size_t k = 3;
+      for (std::size_t i = 0; i < perf_event_count && k < 3 + buf[0]; ++i)
+        if (fds_[i] != -1) v[i] = static_cast<std::int64_t>(static_cast<double>(buf[k++]) * scale);
+#endif
+      return v;
+    }
+
+  private:
+    std::array<int, perf_event_count> fds_;
+
+#ifdef __linux__
+    static int open(perf_event e, int group) {
+      perf_event_attr attr;
+      std::memset(&attr, 0, sizeof attr);
+      attr.size = sizeof attr;
+      attr.disabled = group == -1;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+        PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+      switch (e) {
+        case perf_event::cycles:
+          attr.type = PERF_TYPE_HARDWARE;
+          attr.config = PERF_COUNT_HW_CPU_CYCLES;
+          break;
+        case perf_event::instructions:
+          attr.type = PERF_TYPE_HARDWARE;
+          attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+          break;
+        case perf_event::l1d_misses:
+          attr.type = PERF_TYPE_HW_CACHE;
+          attr.config = PERF_COUNT_HW_CACHE_L1D |
+            (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+            (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+          break;
+        case perf_event::llc_misses:
+          attr.type = PERF_TYPE_HW_CACHE;
+          attr.config = PERF_COUNT_HW_CACHE_LL |
+            (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+            (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+          break;
+        case perf_event::branch_misses:
+          attr.type = PERF_TYPE_HARDWARE;
+          attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+          break;
+        case perf_event::dtlb_misses:
+          attr.type = PERF_TYPE_HW_CACHE;
+          attr.config = PERF_COUNT_HW_CACHE_DTLB |
+            (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+            (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+          break;
+      }
+
+      // the first event leads the group; without a leader nothing is counted
+      if (group == -1 && e != perf_event::cycles)
+        return -1;
+      return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, group, 0));
+    }
+#endif
+  };
+}
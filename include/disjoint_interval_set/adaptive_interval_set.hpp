@@ -0,0 +1,867 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+#include <algorithm>
+#include "disjoint_interval_set.hpp"
+#include "disjoint_interval_set_hash.hpp"
+#include "disjoint_interval_set_memory.hpp"
+#include "interval.hpp"
+
+namespace disjoint_interval_set {
+  /**
+   * The layouts an adaptive_interval_set moves between.
+   *
+   *  - small:  up to N intervals stored inline, no heap allocation.
+   *  - sorted: a sorted vector, best for query-heavy workloads.
+   *  - tree:   an ordered tree keyed by left endpoint, best when updates
+   *            dominate and the set is large.
+   *  - bitmap: one bit per value over the span of the set, for many
+   *            intervals in a dense region of an integral domain.
+   */
+  enum class representation { small, sorted, tree, bitmap };
+
+  /**
+   * Migration thresholds of an adaptive_interval_set.
+   */
+  struct adaptive_thresholds {
+    // operations between two re-evaluations of the layout
+    std::size_t check_every = 64;
+    // the tree layout requires at least this many intervals...
+    std::size_t tree_min_intervals = 256;
+    // ...and at least this fraction of updates among recent operations
+    double tree_min_update_ratio = 0.5;
+    // the bitmap layout requires at least this many intervals...
+    std::size_t bitmap_min_intervals = 64;
+    // ...a span of at most this many bits per interval...
+    std::size_t bitmap_max_bits_per_interval = 64;
+    // ...and a span of at most this many bits overall
+    std::size_t bitmap_max_bits = std::size_t(1) << 26;
+  };
+
+  /**
+   * Statistics an adaptive_interval_set keeps about itself. The operation
+   * counters are halved at every re-evaluation, so they weigh recent
+   * operations more than old ones.
+   */
+  struct adaptive_statistics {
+    std::size_t intervals = 0;
+    std::size_t queries = 0;
+    std::size_t updates = 0;
+    std::size_t migrations = 0;
+    // the number of integral values, or the length, from the least to the
+    // greatest element, and the intervals per unit of it; the bitmap layout
+    // reports the part of its domain in use, which erasures can leave wider
+    // than the set
+    long double span = 0;
+    double density = 0;
+  };
+
+  namespace detail {
+    /**
+     * A fixed-capacity sorted array of at most N intervals.
+     */
+    template <typename I, std::size_t N>
+    struct small_storage {
+      std::array<I, N> s;
+      std::size_t n = 0;
+
+      auto begin() const { return s.begin(); }
+      auto end() const { return s.begin() + n; }
+
+      // replaces the intervals [at, at + removed) with the count intervals
+      // at with; returns false, leaving the storage unchanged, if the result
+      // does not fit
+      bool splice(std::size_t at, std::size_t removed, I const * with, std::size_t count) {
+        if (n - removed + count > N)
+          return false;
+        auto const tail = s.begin() + at + removed;
+        if (count > removed)
+          std::move_backward(tail, s.begin() + n, s.begin() + n + (count - removed));
+        else if (count < removed)
+          std::move(tail, s.begin() + n, s.begin() + at + count);
+        std::copy(with, with + count, s.begin() + at);
+        n = n - removed + count;
+        return true;
+      }
+    };
+
+    /**
+     * One bit per value of an integral domain, from base to base + bits,
+     * with the number of maximal runs of set bits kept up to date, bottom
+     * no higher than the start of the lowest run and top no lower than the
+     * end of the highest. The domain leaves headroom below the lowest run
+     * and above the highest so that sets growing either way rarely leave
+     * it. Offsets from base are computed in the unsigned counterpart of the
+     * value type, so a domain may reach both ends of a signed type without
+     * overflow.
+     *
+     * Above the bits sit summary levels: bit j of full[0] is set when word j
+     * is all ones, bit j of full[k] when word j of full[k - 1] is, up to a
+     * level of one word. They find the ends of a run in O(log64 bits) word
+     * reads however long it is, so updating the fingerprint of a long run
+     * costs no more than updating a short one.
+     */
+    template <typename I>
+    struct bitmap_storage {
+      using value_type = typename I::value_type;
+
+      value_type base = 0;
+      std::size_t bits = 0;
+      std::size_t n = 0;
+      std::size_t bottom = 0;
+      std::size_t top = 0;
+      std::vector<std::uint64_t> words;
+      std::vector<std::vector<std::uint64_t>> full;
+
+      static constexpr auto npos = static_cast<std::size_t>(-1);
+
+      // allocates a domain of the given number of bits, all clear
+      void reset(std::size_t nbits) {
+        bits = nbits;
+        bottom = nbits;
+        top = 0;
+        words.assign((bits + 63) / 64, 0);
+        full.clear();
+        for (auto m = words.size(); m > 1; ) {
+          m = (m + 63) / 64;
+          full.emplace_back(m, 0);
+        }
+      }
+
+      std::vector<std::uint64_t> const & level(std::size_t k) const {
+        return k == 0 ? words : full[k - 1];
+      }
+
+      // brings the summary levels up to date after words [w1, w2] changed
+      void refresh(std::size_t w1, std::size_t w2) {
+        for (std::size_t k = 0; k < full.size(); ++k, w1 /= 64, w2 /= 64) {
+          auto const & below = level(k);
+          for (auto j = w1; j <= w2; ++j) {
+            auto const b = std::uint64_t(1) << (j % 64);
+            if (below[j] == ~std::uint64_t(0)) full[k][j / 64] |= b;
+            else full[k][j / 64] &= ~b;
+          }
+        }
+      }
+
+      // the first clear bit at or after bit i of level k, or the end of it
+      std::size_t next_zero(std::size_t k, std::size_t i) const {
+        auto const & v = level(k);
+        auto w = i / 64;
+        if (w >= v.size()) return v.size() * 64;
+        if (auto const z = ~v[w] & (~std::uint64_t(0) << (i % 64)))
+          return w * 64 + std::countr_zero(z);
+        // the rest of word w is full; find the next word that is not
+        if (k < full.size()) {
+          w = next_zero(k + 1, w + 1);
+        } else {
+          do ++w; while (w < v.size() && v[w] == ~std::uint64_t(0));
+        }
+        if (w >= v.size()) return v.size() * 64;
+        return w * 64 + std::countr_zero(~v[w]);
+      }
+
+      // the last clear bit at or before bit i of level k, or npos
+      std::size_t prev_zero(std::size_t k, std::size_t i) const {
+        auto const & v = level(k);
+        auto w = i / 64;
+        if (auto const z = ~v[w] & mask(i % 64 + 1))
+          return w * 64 + 63 - std::countl_zero(z);
+        if (w == 0) return npos;
+        if (k < full.size()) {
+          w = prev_zero(k + 1, w - 1);
+          if (w == npos) return npos;
+        } else {
+          do --w; while (w != npos && v[w] == ~std::uint64_t(0));
+          if (w == npos) return npos;
+        }
+        return w * 64 + 63 - std::countl_zero(~v[w]);
+      }
+
+      // the closed integral bounds of x
+      static value_type lo(I const & x) { return x.left_open ? x.left + 1 : x.left; }
+      static value_type hi(I const & x) { return x.right_open ? x.right - 1 : x.right; }
+
+      using unsigned_type = typename std::conditional_t<std::is_integral_v<value_type>,
+        std::make_unsigned<value_type>, std::type_identity<value_type>>::type;
+
+      // v - from, exactly, for v no less than from
+      static unsigned_type distance(value_type from, value_type v) {
+        return static_cast<unsigned_type>(static_cast<unsigned_type>(v) - static_cast<unsigned_type>(from));
+      }
+
+      // the value of bit i
+      value_type at(std::size_t i) const {
+        return static_cast<value_type>(static_cast<unsigned_type>(base) + static_cast<unsigned_type>(i));
+      }
+
+      bool in_domain(value_type v) const {
+        return v >= base && static_cast<std::uintmax_t>(distance(base, v)) < bits;
+      }
+
+      static std::uint64_t mask(std::size_t len) {
+        return len == 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << len) - 1;
+      }
+
+      // calls f(word index, offset, length) for the words spanning [first, last]
+      template <typename F>
+      static void for_words(std::size_t first, std::size_t last, F f) {
+        for (auto i = first; i <= last; ) {
+          auto const off = i % 64;
+          auto const len = std::min<std::size_t>(64 - off, last - i + 1);
+          f(i / 64, off, len);
+          i += len;
+        }
+      }
+
+      // the number of runs of set bits that intersect [first, last]
+      std::size_t count_runs(std::size_t first, std::size_t last) const {
+        std::size_t c = 0;
+        std::uint64_t carry = 0;
+        for_words(first, last, [&](std::size_t k, std::size_t off, std::size_t len) {
+          auto const w = (words[k] >> off) & mask(len);
+          c += std::popcount(w & ~((w << 1) | carry));
+          carry = (w >> (len - 1)) & 1;
+        });
+        return c;
+      }
+
+      bool test(std::size_t i) const { return (words[i / 64] >> (i % 64)) & 1; }
+
+      // the first and the last bit of the run of set bits through bit i
+      std::size_t run_first(std::size_t i) const { return prev_zero(0, i) + 1; }
+      std::size_t run_last(std::size_t i) const { return std::min(next_zero(0, i), bits) - 1; }
+
+      I run(std::size_t first, std::size_t last) const { return I(at(first), at(last)); }
+
+      // returns false, leaving the storage unchanged, if x is outside the domain;
+      // adds the change in fingerprint to fp
+      bool insert(I const & x, std::uint64_t & fp) {
+        if (detail::vacuous(x) || lo(x) > hi(x))
+          return true;
+        if (!in_domain(lo(x)) || !in_domain(hi(x)))
+          return false;
+        auto const first = static_cast<std::size_t>(distance(base, lo(x)));
+        auto const last = static_cast<std::size_t>(distance(base, hi(x)));
+        // the run x ends up in spans the runs through its neighbours, and
+        // the runs it replaces lie within it
+        auto const fused_first = first != 0 && test(first - 1) ? run_first(first - 1) : first;
+        auto const fused_last = last + 1 < bits && test(last + 1) ? run_last(last + 1) : last;
+        fp -= runs_hash(fused_first, fused_last);
+        fp += interval_hash(run(fused_first, fused_last));
+        // runs touching [first, last] fuse with x into a single run
+        auto const window_first = first == 0 ? 0 : first - 1;
+        auto const window_last = std::min(last + 1, bits - 1);
+        n -= count_runs(window_first, window_last);
+        for_words(first, last, [&](std::size_t k, std::size_t off, std::size_t len) {
+          words[k] |= mask(len) << off;
+        });
+        refresh(first / 64, last / 64);
+        n += count_runs(window_first, window_last);
+        bottom = std::min(bottom, first);
+        top = std::max(top, last + 1);
+        return true;
+      }
+
+      // clears the values of x, clipped to the domain; adds the change in
+      // fingerprint to fp
+      void erase(I const & x, std::uint64_t & fp) {
+        if (bits == 0 || detail::vacuous(x) || hi(x) < base)
+          return;
+        auto const greatest = at(bits - 1);
+        if (lo(x) > greatest)
+          return;
+        auto const first = lo(x) <= base ? 0 : static_cast<std::size_t>(distance(base, lo(x)));
+        auto const last = hi(x) >= greatest ? bits - 1 : static_cast<std::size_t>(distance(base, hi(x)));
+        // the runs x cuts into, and the pieces of them it leaves
+        auto const cut_first = test(first) ? run_first(first) : first;
+        auto const cut_last = test(last) ? run_last(last) : last;
+        fp -= runs_hash(cut_first, cut_last);
+        if (cut_first < first) fp += interval_hash(run(cut_first, first - 1));
+        if (last < cut_last) fp += interval_hash(run(last + 1, cut_last));
+
+        auto const window_first = first == 0 ? 0 : first - 1;
+        auto const window_last = std::min(last + 1, bits - 1);
+        n -= count_runs(window_first, window_last);
+        for_words(first, last, [&](std::size_t k, std::size_t off, std::size_t len) {
+          words[k] &= ~(mask(len) << off);
+        });
+        refresh(first / 64, last / 64);
+        n += count_runs(window_first, window_last);
+      }
+
+      // the sum of the hashes of the runs that start in [first, last]
+      std::uint64_t runs_hash(std::size_t first, std::size_t last) const {
+        std::uint64_t h = 0;
+        for (auto i = first; i <= last; ) {
+          auto const w = words[i / 64] >> (i % 64);
+          if (w == 0) {
+            i += 64 - i % 64;
+            continue;
+          }
+          i += std::countr_zero(w);
+          if (i > last) break;
+          auto const j = run_last(i);
+          h += interval_hash(run(i, j));
+          i = j + 1;
+        }
+        return h;
+      }
+
+      bool contains(value_type v) const {
+        if (!in_domain(v))
+          return false;
+        return test(static_cast<std::size_t>(distance(base, v)));
+      }
+
+      // appends the runs of set bits as closed intervals
+      void runs(std::vector<I> & out) const {
+        std::size_t i = 0;
+        while (i < bits) {
+          auto const w = words[i / 64] >> (i % 64);
+          if (w == 0) {
+            i += 64 - i % 64;
+            continue;
+          }
+          i += std::countr_zero(w);
+          auto const first = i;
+          for (;;) {
+            auto const off = i % 64;
+            auto const ones = static_cast<std::size_t>(std::countr_one(words[i / 64] >> off));
+            i += ones;
+            if (ones < 64 - off || i >= bits) break;
+          }
+          out.push_back(run(first, i - 1));
+        }
+      }
+    };
+  }
+
+  /**
+   * A set of disjoint intervals that tracks its own shape and workload and
+   * migrates between the layouts of representation. It starts out small
+   * and re-evaluates its layout every thresholds.check_every operations;
+   * a migration goes through the canonical sorted sequence and costs time
+   * linear in the size of the set.
+   *
+   * For integral values every layout holds the same canonical form: closed
+   * intervals, with runs of consecutive integers fused, so that (1,3) is
+   * held as [2,2] and [1,2], [3,4] as [1,4]. size(), intervals() and
+   * fingerprint() therefore do not depend on the layout.
+   *
+   * Every layout keeps the fingerprint of the set up to date as it
+   * absorbs and erases intervals, so fingerprint() costs O(1).
+   *
+   * @tparam I The interval type.
+   * @tparam N The number of intervals stored inline in the small layout.
+   */
+  template <typename I = interval<double>, std::size_t N = 4>
+  class adaptive_interval_set {
+  public:
+    using interval_type = I;
+    using value_type = typename I::value_type;
+
+    adaptive_interval_set() = default;
+    explicit adaptive_interval_set(adaptive_thresholds t) : t_(t) {}
+
+    /**
+     * @brief Constructs the set from a canonical sequence of intervals, such
+     *        as a disjoint_interval_set.
+     */
+    template <typename Set>
+    explicit adaptive_interval_set(Set const & s, adaptive_thresholds t = {}) : t_(t) {
+      auto v = canonical(std::vector<I>(s.begin(), s.end()));
+      auto const r = choose(v);
+      migrate_to(r, std::move(v));
+    }
+
+    /**
+     * @brief Adds the interval x to the set.
+     */
+    void insert(I const & x) {
+      if (detail::vacuous(x) || detail::vacuous(normal(x))) return;
+      ++stats_.updates;
+      auto const y = normal(x);
+      bool const done = std::visit([&](auto & s) { return insert(s, y); }, s_);
+      if (!done) {
+        // the current layout cannot hold the result, so pick another one
+        auto v = intervals();
+        insert(v, y);
+        auto const r = choose(v);
+        migrate_to(r, std::move(v));
+      }
+      tick();
+    }
+
+    /**
+     * @brief Removes the values of the interval x from the set, splitting
+     *        an interval that x cuts in two.
+     */
+    void erase(I const & x) {
+      if (detail::vacuous(x) || detail::vacuous(normal(x))) return;
+      ++stats_.updates;
+      auto const y = normal(x);
+      bool const done = std::visit([&](auto & s) { return erase(s, y); }, s_);
+      if (!done) {
+        auto v = intervals();
+        erase(v, y);
+        auto const r = choose(v);
+        migrate_to(r, std::move(v));
+      }
+      tick();
+    }
+
+    /**
+     * @brief Checks if a value is contained in the set, counting the query
+     *        towards the workload statistics.
+     */
+    bool contains(value_type v) {
+      ++stats_.queries;
+      tick();
+      return std::as_const(*this).contains(v);
+    }
+
+    /**
+     * @brief Checks if a value is contained in the set without recording it.
+     */
+    bool contains(value_type v) const {
+      return std::visit([&](auto const & s) { return contains(s, v); }, s_);
+    }
+
+    /**
+     * @brief The canonical sorted sequence of intervals in the set.
+     */
+    std::vector<I> intervals() const {
+      std::vector<I> v;
+      v.reserve(n_);
+      std::visit([&](auto const & s) { append(s, v); }, s_);
+      return v;
+    }
+
+    /**
+     * @brief The set as a disjoint_interval_set, in memory from a.
+     */
+    template <typename A = std::allocator<I>>
+    disjoint_interval_set<I, A> to_set(A const & a = A()) const {
+      auto const v = intervals();
+      return disjoint_interval_set<I, A>(v.begin(), v.end(), a);
+    }
+
+    /**
+     * @brief The fingerprint of the set, equal to fingerprint(intervals()).
+     */
+    std::uint64_t fingerprint() const { return fp_; }
+
+    auto size() const { return n_; }
+    auto empty() const { return n_ == 0; }
+    auto layout() const { return static_cast<representation>(s_.index()); }
+    auto const & thresholds() const { return t_; }
+    void set_thresholds(adaptive_thresholds t) { t_ = t; }
+
+    adaptive_statistics statistics() const {
+      auto s = stats_;
+      s.intervals = n_;
+      if (n_ != 0) {
+        auto const [first, last] = bounds();
+        s.span = span(first, last);
+        if (s.span > 0) s.density = static_cast<double>(n_ / s.span);
+      }
+      return s;
+    }
+
+    /**
+     * @brief The memory footprint of the current layout.
+     */
+    memory_footprint memory_usage() const {
+      return std::visit([&](auto const & s) { return footprint(s); }, s_);
+    }
+
+    void shrink_to_fit() {
+      if (auto v = std::get_if<std::vector<I>>(&s_)) v->shrink_to_fit();
+      if (auto b = std::get_if<bitmap_type>(&s_)) b->words.shrink_to_fit();
+    }
+
+  private:
+    using small_type = detail::small_storage<I, N>;
+    using tree_type = std::map<value_type, I>;
+    using bitmap_type = detail::bitmap_storage<I>;
+    // the alternatives are in the order of representation
+    using storage = std::variant<small_type, std::vector<I>, tree_type, bitmap_type>;
+
+    storage s_;
+    std::size_t n_ = 0;
+    std::uint64_t fp_ = 0;
+    std::size_t ops_ = 0;
+    adaptive_thresholds t_;
+    adaptive_statistics stats_;
+
+    // a change to a sorted layout: replace the intervals [at, at + removed)
+    // with the count intervals of with, changing the fingerprint by delta
+    struct edit {
+      std::size_t at = 0;
+      std::size_t removed = 0;
+      std::array<I, 2> with{};
+      std::size_t count = 0;
+      std::uint64_t delta = 0;
+    };
+
+    // the canonical form of x: for integral values, the closed interval of
+    // the integers in x; x must not be vacuous
+    static I normal(I const & x) {
+      if constexpr (std::is_integral_v<value_type>)
+        return I(bitmap_type::lo(x), bitmap_type::hi(x));
+      else
+        return x;
+    }
+
+    // x widened by an open unit at both ends for integral values, so that
+    // absorbing it also fuses the intervals that continue its run
+    static I probe(I const & x) {
+      if constexpr (std::is_integral_v<value_type>) {
+        using limits = std::numeric_limits<value_type>;
+        bool const l = x.left != limits::lowest(), r = x.right != limits::max();
+        return I(l ? x.left - 1 : x.left, r ? x.right + 1 : x.right, l, r);
+      } else {
+        return x;
+      }
+    }
+
+    // true if a has no value at or after the start of b
+    static bool ends_before(I const & a, I const & b) {
+      return a.right < b.left || (a.right == b.left && (a.right_open || b.left_open));
+    }
+
+    // the canonical form of a canonical sequence in every layout
+    static std::vector<I> canonical(std::vector<I> v) {
+      if constexpr (std::is_integral_v<value_type>) {
+        std::size_t j = 0;
+        for (auto const & x : v) {
+          if (detail::vacuous(x) || detail::vacuous(normal(x))) continue;
+          auto const y = normal(x);
+          if (j != 0 && (v[j - 1].right == std::numeric_limits<value_type>::max() ||
+                         v[j - 1].right + 1 >= y.left))
+            v[j - 1] = I(v[j - 1].left, std::max(v[j - 1].right, y.right));
+          else
+            v[j++] = y;
+        }
+        v.resize(j);
+      }
+      return v;
+    }
+
+    // the pieces of the intervals from first to last that x leaves
+    static void carve(I const & first, I const & last, I const & x, edit & e) {
+      I const l(first.left, x.left, first.left_open, !x.left_open);
+      I const r(x.right, last.right, !x.right_open, last.right_open);
+      for (auto const & p : {l, r}) {
+        if (detail::vacuous(p) || detail::vacuous(normal(p))) continue;
+        e.with[e.count++] = normal(p);
+        e.delta += detail::interval_hash(normal(p));
+      }
+    }
+
+    // the edit that unions x into the sorted layout s
+    template <typename S>
+    static edit absorbed(S const & s, I const & x) {
+      auto [lo, hi, merged] = detail::absorb(s.begin(), s.end(), probe(x));
+      edit e;
+      e.at = static_cast<std::size_t>(lo - s.begin());
+      e.removed = static_cast<std::size_t>(hi - lo);
+      for (auto i = lo; i != hi; ++i) e.delta -= detail::interval_hash(*i);
+      e.with[0] = normal(merged);
+      e.count = 1;
+      e.delta += detail::interval_hash(e.with[0]);
+      return e;
+    }
+
+    // the edit that removes x from the sorted layout s
+    template <typename S>
+    static edit carved(S const & s, I const & x) {
+      auto const lo = std::lower_bound(s.begin(), s.end(), x, ends_before);
+      auto hi = lo;
+      while (hi != s.end() && !ends_before(x, *hi)) ++hi;
+      edit e;
+      e.at = static_cast<std::size_t>(lo - s.begin());
+      e.removed = static_cast<std::size_t>(hi - lo);
+      if (lo == hi) return e;
+      for (auto i = lo; i != hi; ++i) e.delta -= detail::interval_hash(*i);
+      carve(*lo, *std::prev(hi), x, e);
+      return e;
+    }
+
+    bool apply(small_type & s, edit const & e) {
+      if (!s.splice(e.at, e.removed, e.with.data(), e.count)) return false;
+      fp_ += e.delta;
+      n_ = s.n;
+      return true;
+    }
+
+    bool apply(std::vector<I> & s, edit const & e) {
+      auto const common = std::min(e.removed, e.count);
+      auto const at = s.begin() + static_cast<std::ptrdiff_t>(e.at);
+      std::copy(e.with.begin(), e.with.begin() + common, at);
+      if (e.removed > e.count)
+        s.erase(at + e.count, at + e.removed);
+      else
+        s.insert(at + e.removed, e.with.begin() + common, e.with.begin() + e.count);
+      fp_ += e.delta;
+      n_ = s.size();
+      return true;
+    }
+
+    // re-evaluates the layout every t_.check_every operations
+    void tick() {
+      if (++ops_ < t_.check_every) return;
+      ops_ = 0;
+      auto const target = choose();
+      if (target != layout()) migrate_to(target, intervals());
+      stats_.queries /= 2;
+      stats_.updates /= 2;
+    }
+
+    // the layout for the set as it is stored
+    representation choose() const {
+      return choose(n_, [this] { return bounds(); });
+    }
+
+    // the layout for the canonical sequence v, which the set is about to hold
+    representation choose(std::vector<I> const & v) const {
+      return choose(v.size(), [&v] { return std::make_pair(v.front(), v.back()); });
+    }
+
+    // bounds() returns the least and the greatest interval of n > 0
+    template <typename Bounds>
+    representation choose(std::size_t n, Bounds bounds) const {
+      if (n <= N)
+        return representation::small;
+      if constexpr (std::is_integral_v<value_type>) {
+        if (n >= t_.bitmap_min_intervals) {
+          auto const [first, last] = bounds();
+          auto const bits = span(first, last);
+          if (bits <= t_.bitmap_max_bits &&
+              bits <= n * t_.bitmap_max_bits_per_interval)
+            return representation::bitmap;
+        }
+      }
+      auto const ops = stats_.queries + stats_.updates;
+      if (n >= t_.tree_min_intervals && ops != 0 &&
+          stats_.updates >= t_.tree_min_update_ratio * ops)
+        return representation::tree;
+      return representation::sorted;
+    }
+
+    // the least and the greatest interval of a non-empty set
+    std::pair<I, I> bounds() const {
+      return std::visit([](auto const & s) -> std::pair<I, I> {
+        using S = std::decay_t<decltype(s)>;
+        if constexpr (std::is_same_v<S, tree_type>) {
+          return {s.begin()->second, s.rbegin()->second};
+        } else if constexpr (std::is_same_v<S, bitmap_type>) {
+          auto const first = s.at(s.bottom), last = s.at(s.top - 1);
+          return {I(first, first), I(last, last)};
+        } else {
+          return {*s.begin(), *std::prev(s.end())};
+        }
+      }, s_);
+    }
+
+    // the number of integral values, or the length, from the least to the
+    // greatest element
+    static long double span(I const & first, I const & last) {
+      if constexpr (std::is_integral_v<value_type>)
+        return static_cast<long double>(bitmap_type::hi(last)) -
+               static_cast<long double>(bitmap_type::lo(first)) + 1;
+      else
+        return static_cast<long double>(last.right) - static_cast<long double>(first.left);
+    }
+
+    // rebuilds the set in the given layout from its canonical sequence
+    void migrate_to(representation r, std::vector<I> v) {
+      // never allocate a bitmap beyond the budget, whoever asks for it
+      if (r == representation::bitmap &&
+          (v.empty() || span(v.front(), v.back()) > t_.bitmap_max_bits))
+        r = representation::sorted;
+      n_ = v.size();
+      fp_ = ::disjoint_interval_set::fingerprint(v);
+      ++stats_.migrations;
+      switch (r) {
+        case representation::small: {
+          small_type s;
+          std::copy(v.begin(), v.end(), s.s.begin());
+          s.n = v.size();
+          s_ = s;
+          break;
+        }
+        case representation::sorted:
+          s_ = std::move(v);
+          break;
+        case representation::tree: {
+          tree_type t;
+          for (auto const & i : v) t.emplace_hint(t.end(), i.left, i);
+          s_ = std::move(t);
+          break;
+        }
+        case representation::bitmap:
+          if constexpr (std::is_integral_v<value_type>) {
+            bitmap_type b;
+            // a quarter of the span again as headroom, split between the two
+            // ends and clipped to the range of the value type
+            using limits = std::numeric_limits<value_type>;
+            auto const first = bitmap_type::lo(v.front()), last = bitmap_type::hi(v.back());
+            auto const used = static_cast<std::size_t>(span(v.front(), v.back()));
+            auto const below = static_cast<std::size_t>(std::min<std::uintmax_t>(
+              used / 8, bitmap_type::distance(limits::lowest(), first)));
+            auto const above = static_cast<std::size_t>(std::min<std::uintmax_t>(
+              used / 8, bitmap_type::distance(last, limits::max())));
+            using unsigned_type = typename bitmap_type::unsigned_type;
+            b.base = static_cast<value_type>(static_cast<unsigned_type>(first) -
+                                             static_cast<unsigned_type>(below));
+            b.reset(used + below + above);
+            // runs of integers fuse intervals such as [1,2] and [3,4], and
+            // open ends become closed ones
+            fp_ = 0;
+            for (auto const & i : v) b.insert(i, fp_);
+            n_ = b.n;
+            s_ = std::move(b);
+          }
+          break;
+      }
+    }
+
+    // insert into and erase from each layout, given x in canonical form;
+    // false means the layout cannot hold the result
+    bool insert(small_type & s, I const & x) { return apply(s, absorbed(s, x)); }
+    bool insert(std::vector<I> & s, I const & x) { return apply(s, absorbed(s, x)); }
+    bool erase(small_type & s, I const & x) { return apply(s, carved(s, x)); }
+    bool erase(std::vector<I> & s, I const & x) { return apply(s, carved(s, x)); }
+
+    bool insert(tree_type & t, I const & x) {
+      auto y = probe(x);
+      auto i = t.lower_bound(y.left);
+      if (i != t.begin() && !detail::before(std::prev(i)->second, y))
+        --i;
+      while (i != t.end() && detail::mergeable(y, i->second)) {
+        fp_ -= detail::interval_hash(i->second);
+        y = detail::hull(y, i->second);
+        i = t.erase(i);
+      }
+      auto const merged = normal(y);
+      fp_ += detail::interval_hash(merged);
+      t.emplace_hint(i, merged.left, merged);
+      n_ = t.size();
+      return true;
+    }
+
+    bool erase(tree_type & t, I const & x) {
+      auto i = t.upper_bound(x.left);
+      if (i != t.begin() && !ends_before(std::prev(i)->second, x))
+        --i;
+      if (i == t.end() || ends_before(x, i->second))
+        return true;
+      edit e;
+      auto const first = i->second;
+      I last = first;
+      while (i != t.end() && !ends_before(x, i->second)) {
+        last = i->second;
+        e.delta -= detail::interval_hash(last);
+        i = t.erase(i);
+      }
+      carve(first, last, x, e);
+      for (std::size_t k = 0; k < e.count; ++k)
+        t.emplace_hint(i, e.with[k].left, e.with[k]);
+      fp_ += e.delta;
+      n_ = t.size();
+      return true;
+    }
+
+    bool insert(bitmap_type & b, I const & x) {
+      if (!b.insert(x, fp_)) return false;
+      n_ = b.n;
+      return true;
+    }
+
+    bool erase(bitmap_type & b, I const & x) {
+      b.erase(x, fp_);
+      n_ = b.n;
+      return true;
+    }
+
+    static bool contains(small_type const & s, value_type v) {
+      return detail::sorted_contains(s.begin(), s.end(), v);
+    }
+
+    static bool contains(std::vector<I> const & s, value_type v) {
+      return detail::sorted_contains(s.begin(), s.end(), v);
+    }
+
+    static bool contains(tree_type const & t, value_type v) {
+      auto i = t.upper_bound(v);
+      return i != t.begin() && std::prev(i)->second.contains(v);
+    }
+
+    static bool contains(bitmap_type const & b, value_type v) {
+      return b.contains(v);
+    }
+
+    static void append(small_type const & s, std::vector<I> & v) {
+      v.insert(v.end(), s.begin(), s.end());
+    }
+
+    static void append(std::vector<I> const & s, std::vector<I> & v) {
+      v.insert(v.end(), s.begin(), s.end());
+    }
+
+    static void append(tree_type const & t, std::vector<I> & v) {
+      for (auto const & [_, i] : t) v.push_back(i);
+    }
+
+    static void append(bitmap_type const & b, std::vector<I> & v) {
+      b.runs(v);
+    }
+
+    memory_footprint footprint(small_type const &) const {
+      memory_footprint m;
+      m.intervals = n_;
+      m.padding_bytes = n_ * interval_padding<I>();
+      return m;
+    }
+
+    memory_footprint footprint(std::vector<I> const & s) const {
+      return contiguous_footprint(s);
+    }
+
+    memory_footprint footprint(tree_type const & t) const {
+      // a red-black tree node holds three pointers and a color besides the
+      // value; the node overhead is reported as slack
+      constexpr std::size_t node = sizeof(typename tree_type::value_type) + 4 * sizeof(void *);
+      memory_footprint m;
+      m.intervals = t.size();
+      m.heap_bytes = t.size() * node;
+      m.slack_bytes = t.size() * (node - sizeof(I));
+      m.padding_bytes = t.size() * interval_padding<I>();
+      return m;
+    }
+
+    memory_footprint footprint(bitmap_type const & b) const {
+      memory_footprint m;
+      m.intervals = n_;
+      m.heap_bytes = b.words.capacity() * sizeof(std::uint64_t);
+      m.slack_bytes = (b.words.capacity() - b.words.size()) * sizeof(std::uint64_t);
+      // the summary levels are part of the layout, not slack
+      for (auto const & l : b.full) {
+        m.heap_bytes += l.capacity() * sizeof(std::uint64_t);
+        m.slack_bytes += (l.capacity() - l.size()) * sizeof(std::uint64_t);
+      }
+      return m;
+    }
+  };
+}
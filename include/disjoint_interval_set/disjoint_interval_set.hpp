@@ -1,43 +1,101 @@
 #pragma once
 
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <utility>
 #include <vector>
 #include "disjoint_interval_set_algorithms.hpp"
+#include "disjoint_interval_set_memory.hpp"
 #include "interval.hpp"
 
 namespace disjoint_interval_set
 {
+  template <typename I>
+  struct interval_patch;
+
   /**
    * Models the concept of a disjoint set of intervals. It is a Boolean
    * algebra over disjoint interval sets equipped with all the standard
    * set-theoretic operations, like intersection (*), union (+), and
    * complement (~).
+   *
+   * The intervals are stored contiguously, in memory from Alloc.
    */
-  template <typename I = interval<double>>
+  template <typename I = interval<double>, typename Alloc = std::allocator<I>>
   class disjoint_interval_set {
-    friend auto operator*<>(disjoint_interval_set const &,
-                            disjoint_interval_set const &);
+    template <typename J, typename B>
+    friend auto operator~(disjoint_interval_set<J, B>);
+    template <typename J, typename B>
+    friend auto operator+(disjoint_interval_set<J, B> const &, disjoint_interval_set<J, B>);
+    template <typename Sets>
+    friend auto at_least_k(Sets const &, std::size_t);
+    template <typename J, typename B>
+    friend auto dilate(disjoint_interval_set<J, B>, typename J::value_type);
+    template <typename J, typename B>
+    friend auto erode(disjoint_interval_set<J, B>, typename J::value_type);
+    template <typename J, typename B>
+    friend auto close_gaps(disjoint_interval_set<J, B>, typename J::value_type);
+    template <typename J, typename B>
+    friend auto & shift(disjoint_interval_set<J, B> &, typename J::value_type);
+    template <typename J, typename B>
+    friend auto & scale(disjoint_interval_set<J, B> &, typename J::value_type);
+    template <typename J, typename B>
+    friend auto snap_outward(disjoint_interval_set<J, B>, typename J::value_type);
+    template <typename J, typename B>
+    friend auto snap_inward(disjoint_interval_set<J, B>, typename J::value_type);
+    template <typename J, typename B>
+    friend auto apply_patch(disjoint_interval_set<J, B>, interval_patch<J> const &);
   public:
     using interval_type = I;
     using value_type = typename I::value_type;
-    using const_iterator = typename std::vector<I>::const_iterator;
+    using allocator_type = Alloc;
+    using const_iterator = typename std::vector<I, Alloc>::const_iterator;
 
     // constuctors
     disjoint_interval_set() = default;
     disjoint_interval_set(const disjoint_interval_set &) = default;
+    explicit disjoint_interval_set(Alloc const & a) : s_(a) {}
+
+    /**
+     * @brief Constructs the set of the intervals in [first, last), in any
+     *        order, coalescing the ones that overlap or touch.
+     */
+    template <typename It>
+    disjoint_interval_set(It first, It last, Alloc const & a = Alloc()) :
+      s_(make_disjoint_interval_set(std::vector<I, Alloc>(first, last, a))) {}
+
+    /**
+     * @brief Constructs the set of the intervals in a range, such as a
+     *        std::vector of intervals.
+     */
+    template <typename Range, typename = decltype(std::begin(std::declval<Range const &>()))>
+    explicit disjoint_interval_set(Range const & intervals, Alloc const & a = Alloc()) :
+      disjoint_interval_set(std::begin(intervals), std::end(intervals), a) {}
 
     // accessors
-    auto supremum() const { return empty() ? std::nullopt : supremum(s_.back()); }
-    auto infimum() const { return empty() ? std::nullopt : infimum(s_.front()); }
+    auto supremum() const {
+      return empty() ? std::optional<value_type>() : ::disjoint_interval_set::supremum(s_.back());
+    }
+    auto infimum() const {
+      return empty() ? std::optional<value_type>() : ::disjoint_interval_set::infimum(s_.front());
+    }
     auto contains(value_type v) const {
-      return any_of(begin(), end(), [v](I const &i)
-                    { return i.contains(v); });
+      return detail::sorted_contains(begin(), end(), v);
     }
     auto empty() const { return s_.empty(); }
+    auto size() const { return s_.size(); }
+    auto get_allocator() const { return s_.get_allocator(); }
     auto begin() const { return s_.begin(); }
     auto end() const { return s_.end(); }
 
+    // memory
+    auto memory_usage() const { return contiguous_footprint(s_); }
+    void shrink_to_fit() { s_.shrink_to_fit(); }
+
   private:
-    std::vector<I> s_;
+    std::vector<I, Alloc> s_;
   };
 
   using reals = disjoint_interval_set<interval<double>>;
@@ -48,51 +106,51 @@ namespace disjoint_interval_set
    */
 
   // subset predicate
-  template <typename I, typename A, typename C>
-  auto operator<=(disjoint_interval_set<I> const &lhs,
-                  disjoint_interval_set<I> const &rhs) {
+  template <typename I, typename A>
+  auto operator<=(disjoint_interval_set<I, A> const &lhs,
+                  disjoint_interval_set<I, A> const &rhs) {
     auto i = lhs.begin();
     auto j = rhs.begin();
     while (i != lhs.end() && j != rhs.end()) {
-      if (i->contains(*j)) ++j;
-      else ++i;
+      if (*i < *j) ++i;
+      else ++j;
     }
-    return j == rhs.end();
+    return i == lhs.end();
   }
 
   // superset predicate
-  template <typename I>
-  auto operator>=(disjoint_interval_set<I> const &lhs,
-                  disjoint_interval_set<I> const &rhs) {
+  template <typename I, typename A>
+  auto operator>=(disjoint_interval_set<I, A> const &lhs,
+                  disjoint_interval_set<I, A> const &rhs) {
     return rhs <= lhs;
   }
 
   // equality predicate
-  template <typename I>
-  auto operator==(disjoint_interval_set<I> const &lhs,
-                  disjoint_interval_set<I> const &rhs) {
+  template <typename I, typename A>
+  auto operator==(disjoint_interval_set<I, A> const &lhs,
+                  disjoint_interval_set<I, A> const &rhs) {
     return (rhs <= lhs) && (lhs <= rhs);
   }
 
   // inequality predicate
-  template <typename I>
-  auto operator!=(disjoint_interval_set<I> const &lhs,
-                  disjoint_interval_set<I> const &rhs) {
+  template <typename I, typename A>
+  auto operator!=(disjoint_interval_set<I, A> const &lhs,
+                  disjoint_interval_set<I, A> const &rhs) {
     return !(lhs == rhs);
   }
 
   // proper subset predicate
-  template <typename I>
-  auto operator<(disjoint_interval_set<I> const &lhs,
-                 disjoint_interval_set<I> const &rhs) {
+  template <typename I, typename A>
+  auto operator<(disjoint_interval_set<I, A> const &lhs,
+                 disjoint_interval_set<I, A> const &rhs) {
     return (lhs <= rhs) && (lhs != rhs);
   }
 
   // proper superset predicate
-  template <typename I>
-  auto operator>(disjoint_interval_set<I> const &lhs,
-                 disjoint_interval_set<I> const &rhs) {
-    return (lhs >= lhs) && (lhs != rhs);
+  template <typename I, typename A>
+  auto operator>(disjoint_interval_set<I, A> const &lhs,
+                 disjoint_interval_set<I, A> const &rhs) {
+    return (lhs >= rhs) && (lhs != rhs);
   }
 
   /**
@@ -100,40 +158,149 @@ namespace disjoint_interval_set
    */
 
   // intersection
-  template <typename I>
-  auto operator*(disjoint_interval_set<I> lhs,
-                 disjoint_interval_set<I> rhs) {
-    return ~((~move(lhs)) + (~move(rhs)));
+  template <typename I, typename A>
+  auto operator*(disjoint_interval_set<I, A> lhs,
+                 disjoint_interval_set<I, A> rhs) {
+    return ~((~std::move(lhs)) + (~std::move(rhs)));
   }
 
-  template <typename I>
-  auto operator^(disjoint_interval_set<I> const &lhs,
-                 disjoint_interval_set<I> const &rhs) {
+  template <typename I, typename A>
+  auto operator^(disjoint_interval_set<I, A> const &lhs,
+                 disjoint_interval_set<I, A> const &rhs) {
     return (lhs * (~rhs)) + (~(lhs)*rhs);
   }
 
   // complement
-  template <typename T>
-  auto operator~(disjoint_interval_set<T> x) {
-    x.s_ = complement_disjoint_interval_set(move(x.s_));
+  template <typename T, typename A>
+  auto operator~(disjoint_interval_set<T, A> x) {
+    x.s_ = complement_disjoint_interval_set(std::move(x.s_));
     return x;
   }
 
   // set-difference
-  template <typename T>
-  auto operator-(disjoint_interval_set<T> lhs, disjoint_interval_set<T> rhs) {
-    return move(lhs) * (~move(rhs));
+  template <typename T, typename A>
+  auto operator-(disjoint_interval_set<T, A> lhs, disjoint_interval_set<T, A> rhs) {
+    return std::move(lhs) * (~std::move(rhs));
   }
 
   // union
-  template <typename I>
-  auto operator+(disjoint_interval_set<I> const &lhs,
-                 disjoint_interval_set<I> rhs) {
+  template <typename I, typename A>
+  auto operator+(disjoint_interval_set<I, A> const &lhs,
+                 disjoint_interval_set<I, A> rhs) {
     if (lhs.empty()) return rhs;
     if (rhs.empty()) return lhs;
 
-    rhs.s_.insert(rhs.s_.end(), lhs.s_.begin(), lhs.s_.end());
-    rhs.s_ = disjoint_interval_set<I>(rhs.s_.begin(), rhs.s_.end()));
+    rhs.s_ = union_disjoint_interval_sets(std::move(rhs.s_), lhs.s_);
     return rhs;
   }
+
+  /**
+   * threshold union
+   */
+
+  // the regions covered by at least k of the sets, in memory from the
+  // allocator of the first set
+  template <typename Sets>
+  auto at_least_k(Sets const & sets, std::size_t k) {
+    using set_type = std::decay_t<decltype(*std::begin(sets))>;
+    auto const a = std::begin(sets) == std::end(sets) ?
+      typename set_type::allocator_type() : std::begin(sets)->get_allocator();
+    set_type r(a);
+    r.s_ = at_least_k_disjoint_interval_sets(sets, k, decltype(r.s_)(a));
+    return r;
+  }
+
+  /**
+   * coverage histograms
+   */
+
+  // the covered measure in each of nbins bins of width bin_width from origin
+  template <typename I, typename A>
+  auto histogram(disjoint_interval_set<I, A> const & s,
+                 typename I::value_type origin,
+                 typename I::value_type bin_width, std::size_t nbins) {
+    std::vector<typename I::value_type> h(nbins);
+    histogram_disjoint_interval_set(s, origin, bin_width, nbins, h.data());
+    return h;
+  }
+
+  // the histograms of many sets over the same bins, as the rows of a
+  // row-major matrix with nbins columns; the matrix is allocated once and
+  // every set shares one difference array
+  template <typename Sets>
+  auto histograms(Sets const & sets,
+                  typename std::decay_t<decltype(*std::begin(sets))>::value_type origin,
+                  typename std::decay_t<decltype(*std::begin(sets))>::value_type bin_width,
+                  std::size_t nbins) {
+    auto const rows = static_cast<std::size_t>(std::distance(std::begin(sets), std::end(sets)));
+    std::vector<std::decay_t<decltype(origin)>> h(rows * nbins);
+    std::vector<std::ptrdiff_t> whole;
+    auto row = h.data();
+    for (auto const & s : sets) {
+      histogram_disjoint_interval_set(s, origin, bin_width, nbins, row, whole);
+      row += nbins;
+    }
+    return h;
+  }
+
+  /**
+   * morphological operations
+   */
+
+  // expands every interval by eps at both ends
+  template <typename I, typename A>
+  auto dilate(disjoint_interval_set<I, A> x, typename I::value_type eps) {
+    x.s_ = dilate_disjoint_interval_set(std::move(x.s_), eps);
+    return x;
+  }
+
+  // shrinks every interval by eps at both ends
+  template <typename I, typename A>
+  auto erode(disjoint_interval_set<I, A> x, typename I::value_type eps) {
+    x.s_ = erode_disjoint_interval_set(std::move(x.s_), eps);
+    return x;
+  }
+
+  // fuses intervals separated by gaps no longer than max_gap
+  template <typename I, typename A>
+  auto close_gaps(disjoint_interval_set<I, A> x, typename I::value_type max_gap) {
+    x.s_ = close_gaps_disjoint_interval_set(std::move(x.s_), max_gap);
+    return x;
+  }
+
+  /**
+   * affine transforms, in place
+   */
+
+  // translates every element by delta
+  template <typename I, typename A>
+  auto & shift(disjoint_interval_set<I, A> & x, typename I::value_type delta) {
+    shift_disjoint_interval_set(x.s_, delta);
+    return x;
+  }
+
+  // multiplies every element by factor
+  template <typename I, typename A>
+  auto & scale(disjoint_interval_set<I, A> & x, typename I::value_type factor) {
+    scale_disjoint_interval_set(x.s_, factor);
+    return x;
+  }
+
+  /**
+   * grid snapping
+   */
+
+  // rounds endpoints outward to multiples of grid, coalescing as needed
+  template <typename I, typename A>
+  auto snap_outward(disjoint_interval_set<I, A> x, typename I::value_type grid) {
+    x.s_ = snap_outward_disjoint_interval_set(std::move(x.s_), grid);
+    return x;
+  }
+
+  // rounds endpoints inward to multiples of grid
+  template <typename I, typename A>
+  auto snap_inward(disjoint_interval_set<I, A> x, typename I::value_type grid) {
+    x.s_ = snap_inward_disjoint_interval_set(std::move(x.s_), grid);
+    return x;
+  }
 }
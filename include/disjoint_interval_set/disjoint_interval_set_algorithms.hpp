@@ -2,30 +2,109 @@
 
 #include <vector>
 #include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <queue>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <type_traits>
+#include "disjoint_interval_set_trace.hpp"
 using std::sort;
 using std::numeric_limits;
 
 namespace disjoint_interval_set {
+	namespace detail {
+		// true if x contains no value, including the degenerate [a,a), (a,a]
+		// and (a,a)
+		template <typename I>
+		bool vacuous(I const & x) {
+			return x.empty() || (x.left == x.right && (x.left_open || x.right_open));
+		}
+
+		// true if a lies entirely before b without touching it
+		template <typename I>
+		bool before(I const & a, I const & b) {
+			return a.right < b.left ||
+				(a.right == b.left && a.right_open && b.left_open);
+		}
+
+		// true if a, which starts no later than b, overlaps or touches b
+		template <typename I>
+		bool mergeable(I const & a, I const & b) {
+			return a.right > b.left ||
+				(a.right == b.left && !(a.right_open && b.left_open));
+		}
+
+		// the smallest interval covering a and b, given mergeable(a, b)
+		template <typename I>
+		I hull(I const & a, I const & b) {
+			auto const & l = (a.left < b.left || (a.left == b.left && !a.left_open)) ? a : b;
+			auto const & r = (a.right > b.right || (a.right == b.right && !a.right_open)) ? a : b;
+			return I(l.left, r.right, l.left_open, r.right_open);
+		}
+
+		// unions x into the canonical range [first, last) of a sorted
+		// sequence, returning the range of intervals x absorbs and the merged
+		// interval that replaces them
+		template <typename It, typename I>
+		auto absorb(It first, It last, I x) {
+			auto lo = std::lower_bound(first, last, x, before<I>);
+			auto hi = lo;
+			while (hi != last && mergeable(x, *hi)) {
+				x = hull(x, *hi);
+				++hi;
+			}
+			return std::make_tuple(lo, hi, x);
+		}
+
+		// true if the canonical range [first, last) contains v
+		template <typename It, typename T>
+		bool sorted_contains(It first, It last, T v) {
+			auto i = std::upper_bound(first, last, v,
+				[](T const & x, auto const & j) { return x < j.left; });
+			return i != first && std::prev(i)->contains(v);
+		}
+
+		// appends x to the canonical prefix [s.begin(), j), fusing it with
+		// the last interval if they overlap or touch; x must start no earlier
+		// than that interval
+		template <typename Set, typename It, typename I>
+		It push_coalesced(Set & s, It j, I const & x) {
+			if (j != s.begin() && mergeable(*std::prev(j), x)) {
+				*std::prev(j) = hull(*std::prev(j), x);
+				return j;
+			}
+			*j = x;
+			return ++j;
+		}
+	}
+
+	/**
+	 * @brief Sorts a sequence of intervals and coalesces the ones that
+	 *        overlap or touch, dropping empty ones, to give a disjoint set
+	 *        of intervals.
+	 *
+	 * @param s A sequence of intervals, in any order.
+	 * @return The canonical form of s.
+	 */
 	template <typename Set>
 	auto make_disjoint_interval_set(Set s) {
 		using interval_type = typename Set::value_type;
-		sort(s.begin(), s.end(), std::less<interval_type>{});
+		{
+			trace_scope trace(trace_phase::sort, s.size());
+			sort(s.begin(), s.end(), std::less<interval_type>{});
+		}
 
-		auto l = infinum(*s.begin());
-		auto r = supremum(*s.begin());
+		trace_scope trace(trace_phase::coalesce, s.size());
 		auto j = s.begin();
-		for (const auto& i : s) {
-			if (infimum(i) > r) {
-				*j++ = interval_type(l, r);
-				l = infimum(i);
-				r = supremum(i);
-			}
-			else if (supremum(i) > r) {
-				r = supremum(i);
-			}
+		for (auto i = s.begin(); i != s.end(); ++i) {
+			if (!detail::vacuous(*i))
+				j = detail::push_coalesced(s, j, interval_type(*i));
 		}
-		*j++ = interval_type(l, r);
 		s.erase(j, s.end());
+		trace.output(s.size());
 		return s;
 	}
 
@@ -40,8 +119,11 @@ namespace disjoint_interval_set {
 	auto union_disjoint_interval_sets(Set1 s1, const Set2& s2) {
 		if (s1.empty())	return Set1(s2.begin(), s2.end());
 		if (s2.empty()) return s1;
-		
-		s1.insert(s1.end(), s2.begin(), s2.end());
+
+		{
+			trace_scope trace(trace_phase::allocate, s1.size() + s2.size());
+			s1.insert(s1.end(), s2.begin(), s2.end());
+		}
 		return make_disjoint_interval_set(s1);
 	};
 
@@ -51,9 +133,27 @@ namespace disjoint_interval_set {
 	template <typename Set>
 	using interval_value_type = typename interval_type<Set>::value_type;
 
+	namespace detail {
+		// the least and the greatest value of T, infinite where T has them
+		template <typename T>
+		T lowest() {
+			return std::numeric_limits<T>::has_infinity ?
+				-std::numeric_limits<T>::infinity() : std::numeric_limits<T>::lowest();
+		}
+
+		template <typename T>
+		T highest() {
+			return std::numeric_limits<T>::has_infinity ?
+				std::numeric_limits<T>::infinity() : std::numeric_limits<T>::max();
+		}
+	}
+
 	/**
 	 * @brief Takes the complement of a disjoint set of interval types.
 	 * 
+	 * The complement is taken within the closed range [l, u], which by
+	 * default spans every value of the type, infinities included.
+	 *
 	 * @param s A disjoint set of intervals.
 	 * @param l The lower limit of the set.
 	 * @param u The upper limit of the set.
@@ -61,24 +161,502 @@ namespace disjoint_interval_set {
 	 */
 	template <typename Set>
 	Set complement_disjoint_interval_set(Set s,
-		interval_value_type<Set> l = -std::numeric_limits<interval_value_type<Set>>::infinity(),
-		interval_value_type<Set> u = std::numeric_limits<interval_value_type<Set>>::infinity()) {
+		interval_value_type<Set> l = detail::lowest<interval_value_type<Set>>(),
+		interval_value_type<Set> u = detail::highest<interval_value_type<Set>>()) {
 		using interval = interval_type<Set>;
 
-		sort(s.begin(), s.end(),
-			[](interval const & v1, interval const & v2) {
-					if (infimum(v1) < infimum(v2)) return true;
-					if (infimum(v2) < infimum(v1)) return false;
-					return !is_left_open(v1) && is_right_open(v2);
-				});
+		{
+			trace_scope trace(trace_phase::sort, s.size());
+			sort(s.begin(), s.end(), std::less<interval>{});
+		}
 
-		Set comp;
+		trace_scope trace(trace_phase::complement, s.size());
+		Set comp(s.get_allocator());
+		// each gap runs from the end of one interval to the start of the next
 		auto lr = l;
+		bool lr_open = false;
 		for (const auto& i : s)	{
-			if (i.min() != l) comp.push_back(interval(lr, i.min()));
-			lr = i.max();
+			interval const gap(lr, i.left, lr_open, !i.left_open);
+			if (!detail::vacuous(gap)) comp.push_back(gap);
+			lr = i.right;
+			lr_open = !i.right_open;
 		}
-		if (lr != u) comp.push_back(interval(lr, u));
+		interval const gap(lr, u, lr_open, false);
+		if (!detail::vacuous(gap)) comp.push_back(gap);
+		trace.output(comp.size());
 		return comp;
 	}
+
+	/**
+	 * @brief The regions covered by at least k of n disjoint interval sets,
+	 *        computed in one k-way sweep over their endpoints.
+	 *
+	 * The sets are merged through a heap of cursors, one per set, while a
+	 * depth counter tracks how many sets cover the current position. A
+	 * region is emitted whenever the depth crosses k. With k = 1 this is
+	 * the union, and with k = n the intersection. Runs in O(N log n) for N
+	 * intervals in total.
+	 *
+	 * An endpoint is ordered by its value and then by whether it applies
+	 * just before, at (rank 0) or just after (rank 1) that value, so that
+	 * e.g. [1,2) and (2,3] leave 2 uncovered.
+	 *
+	 * Every point is covered by at least 0 sets, so with k = 0 the result is
+	 * the whole domain, as for the complement of the empty set.
+	 *
+	 * @param sets A range of disjoint interval sets, each in canonical order.
+	 * @param k The threshold.
+	 * @param out An empty sequence container to append the result to, such
+	 *            as a vector with the allocator of the caller.
+	 * @return out, holding the canonical sequence of intervals covered by at
+	 *         least k sets.
+	 */
+	template <typename Sets, typename Out>
+	Out at_least_k_disjoint_interval_sets(Sets const & sets, std::size_t k, Out out) {
+		using set_type = std::decay_t<decltype(*std::begin(sets))>;
+		using iterator = decltype(std::declval<set_type const &>().begin());
+		using interval = std::decay_t<decltype(*std::declval<iterator>())>;
+		using value_type = typename interval::value_type;
+		using key = std::pair<value_type, int>;
+
+		if (k == 0) {
+			out.push_back(interval(detail::lowest<value_type>(), detail::highest<value_type>()));
+			return out;
+		}
+
+		// the next endpoint of a set is the right one of *i if in, else the left one
+		struct cursor { iterator i, e; bool in; };
+		auto next = [](cursor const & c) {
+			return c.in ? key(c.i->right, c.i->right_open ? 0 : 1)
+			            : key(c.i->left, c.i->left_open ? 1 : 0);
+		};
+
+		std::vector<cursor> cs;
+		for (auto const & s : sets)
+			if (s.begin() != s.end())
+				cs.push_back(cursor{s.begin(), s.end(), false});
+
+		auto later = [&](std::size_t a, std::size_t b) { return next(cs[b]) < next(cs[a]); };
+		std::priority_queue<std::size_t, std::vector<std::size_t>, decltype(later)> heap(later);
+		for (std::size_t c = 0; c < cs.size(); ++c)
+			heap.push(c);
+
+		std::size_t depth = 0;
+		value_type l{};
+		bool l_open = false;
+		while (!heap.empty()) {
+			auto const at = next(cs[heap.top()]);
+			auto const before = depth;
+			// apply every endpoint at this position before comparing with k
+			while (!heap.empty() && next(cs[heap.top()]) == at) {
+				auto const c = heap.top();
+				heap.pop();
+				if (cs[c].in) {
+					--depth;
+					cs[c].in = false;
+					if (++cs[c].i == cs[c].e)
+						continue;
+				} else {
+					++depth;
+					cs[c].in = true;
+				}
+				heap.push(c);
+			}
+			if (before < k && depth >= k) {
+				l = at.first;
+				l_open = at.second == 1;
+			} else if (before >= k && depth < k) {
+				out.push_back(interval(l, at.first, l_open, at.second == 0));
+			}
+		}
+		return out;
+	}
+
+	/**
+	 * @brief The regions covered by at least k of n disjoint interval sets,
+	 *        as a std::vector of intervals.
+	 */
+	template <typename Sets>
+	auto at_least_k_disjoint_interval_sets(Sets const & sets, std::size_t k) {
+		using set_type = std::decay_t<decltype(*std::begin(sets))>;
+		using interval = std::decay_t<decltype(*std::declval<set_type const &>().begin())>;
+		return at_least_k_disjoint_interval_sets(sets, k, std::vector<interval>());
+	}
+
+	/**
+	 * @brief Adds the measure of a disjoint set of intervals covered by each
+	 *        of nbins bins of equal width to out[0], ..., out[nbins - 1].
+	 *
+	 * Runs in a single pass over the intervals plus one over the bins: the
+	 * partial bins at the ends of an interval are computed directly, and
+	 * the whole bins in between are recorded in a difference array, so an
+	 * interval costs O(1) no matter how many bins it spans.
+	 *
+	 * @param s A disjoint set of intervals.
+	 * @param origin The left edge of the first bin.
+	 * @param width The width of a bin.
+	 * @param nbins The number of bins.
+	 * @param out The nbins measures to add to.
+	 * @param whole Scratch space for the difference array, reused across
+	 *              calls so that histograms of many sets allocate it once.
+	 */
+	template <typename Set, typename T>
+	void histogram_disjoint_interval_set(Set const & s, T origin, T width,
+		std::size_t nbins, T * out, std::vector<std::ptrdiff_t> & whole) {
+		if (nbins == 0)
+			return;
+
+		T const end = origin + static_cast<T>(nbins) * width;
+		auto bin = [&](T x) {
+			auto const b = static_cast<std::size_t>((x - origin) / width);
+			return b < nbins ? b : nbins - 1;
+		};
+
+		// whole bins covered, as a difference array
+		whole.assign(nbins + 1, 0);
+		for (auto const & i : s) {
+			if (i.right <= origin || i.left >= end)
+				continue;
+			T const l = i.left < origin ? origin : i.left;
+			T const r = i.right > end ? end : i.right;
+			auto const a = bin(l), b = bin(r);
+			if (a == b) {
+				out[a] += r - l;
+				continue;
+			}
+			out[a] += origin + static_cast<T>(a + 1) * width - l;
+			out[b] += r - (origin + static_cast<T>(b) * width);
+			++whole[a + 1];
+			--whole[b];
+		}
+
+		std::ptrdiff_t covering = 0;
+		for (std::size_t b = 0; b < nbins; ++b) {
+			covering += whole[b];
+			out[b] += static_cast<T>(covering) * width;
+		}
+	}
+
+	template <typename Set, typename T>
+	void histogram_disjoint_interval_set(Set const & s, T origin, T width,
+		std::size_t nbins, T * out) {
+		std::vector<std::ptrdiff_t> whole;
+		histogram_disjoint_interval_set(s, origin, width, nbins, out, whole);
+	}
+
+	/**
+	 * @brief Expands every interval of a disjoint set by eps at both ends.
+	 *
+	 * Shifting all left (and all right) endpoints by the same amount keeps
+	 * them in order, so the result is coalesced in place in a single pass
+	 * without sorting.
+	 *
+	 * @param s A disjoint set of intervals.
+	 * @param eps The non-negative amount to expand by.
+	 * @return The dilation of s, which is another disjoint set of intervals.
+	 * @throws std::invalid_argument if eps is negative.
+	 */
+	template <typename Set>
+	Set dilate_disjoint_interval_set(Set s, interval_value_type<Set> eps) {
+		using interval = interval_type<Set>;
+
+		// a negative eps would move left endpoints past their predecessors'
+		if (eps < interval_value_type<Set>(0))
+			throw std::invalid_argument("dilate: negative eps");
+		auto j = s.begin();
+		for (auto const & i : s) {
+			interval const x(i.left - eps, i.right + eps, i.left_open, i.right_open);
+			j = detail::push_coalesced(s, j, x);
+		}
+		s.erase(j, s.end());
+		return s;
+	}
+
+	/**
+	 * @brief Shrinks every interval of a disjoint set by eps at both ends,
+	 *        dropping the ones that vanish.
+	 *
+	 * @param s A disjoint set of intervals.
+	 * @param eps The non-negative amount to shrink by.
+	 * @return The erosion of s, which is another disjoint set of intervals.
+	 * @throws std::invalid_argument if eps is negative.
+	 */
+	template <typename Set>
+	Set erode_disjoint_interval_set(Set s, interval_value_type<Set> eps) {
+		using interval = interval_type<Set>;
+
+		// a negative eps would grow intervals into their neighbours
+		if (eps < interval_value_type<Set>(0))
+			throw std::invalid_argument("erode: negative eps");
+		auto j = s.begin();
+		for (auto const & i : s) {
+			interval const x(i.left + eps, i.right - eps, i.left_open, i.right_open);
+			if (!detail::vacuous(x))
+				*j++ = x;
+		}
+		s.erase(j, s.end());
+		return s;
+	}
+
+	/**
+	 * @brief Fuses consecutive intervals of a disjoint set that are separated
+	 *        by gaps no longer than max_gap, in a single pass.
+	 *
+	 * A gap exactly max_gap long is closed only if it is not closed at both
+	 * ends, as dilating by max_gap / 2 and eroding back would do: max_gap 0
+	 * fuses nothing, and [1, 2) and (2, 3] stay apart around the point 2.
+	 *
+	 * @param s A disjoint set of intervals.
+	 * @param max_gap The longest gap to close.
+	 * @return s with its short gaps closed, which is another disjoint set of
+	 *         intervals.
+	 */
+	template <typename Set>
+	Set close_gaps_disjoint_interval_set(Set s, interval_value_type<Set> max_gap) {
+		using interval = interval_type<Set>;
+
+		// the gap before i is open at an end where an interval is closed
+		auto const closes = [max_gap](interval const & last, interval const & i) {
+			auto const gap = i.left - last.right;
+			return gap < max_gap ||
+				(gap == max_gap && !(last.right_open && i.left_open));
+		};
+
+		auto j = s.begin();
+		for (auto const & i : s) {
+			if (j != s.begin() && closes(*std::prev(j), i)) {
+				auto & last = *std::prev(j);
+				last = interval(last.left, i.right, last.left_open, i.right_open);
+			} else {
+				*j++ = i;
+			}
+		}
+		s.erase(j, s.end());
+		return s;
+	}
+
+	/**
+	 * @brief Translates a disjoint set of intervals by delta in place.
+	 *
+	 * Order is preserved, so this is a single loop over the contiguous
+	 * endpoint storage with no sorting or reallocation, which compilers
+	 * vectorize.
+	 *
+	 * @param s A disjoint set of intervals.
+	 * @param delta The amount to translate by.
+	 */
+	template <typename Set>
+	void shift_disjoint_interval_set(Set & s, interval_value_type<Set> delta) {
+		using interval = interval_type<Set>;
+
+		for (auto & i : s)
+			i = interval(i.left + delta, i.right + delta, i.left_open, i.right_open);
+	}
+
+	/**
+	 * @brief Multiplies every element of a disjoint set of intervals by
+	 *        factor in place.
+	 *
+	 * A positive factor preserves order. A negative one reverses it and
+	 * swaps the openness of the endpoints, which is done in the same pass by
+	 * walking in from both ends. A zero factor maps every interval to the
+	 * single point zero.
+	 *
+	 * @param s A disjoint set of intervals.
+	 * @param factor The amount to scale by.
+	 */
+	template <typename Set>
+	void scale_disjoint_interval_set(Set & s, interval_value_type<Set> factor) {
+		using interval = interval_type<Set>;
+		using value_type = interval_value_type<Set>;
+
+		if (factor == value_type(0)) {
+			if (!s.empty()) {
+				s.erase(std::next(s.begin()), s.end());
+				s.front() = interval(0, 0);
+			}
+			return;
+		}
+		if (factor > value_type(0)) {
+			for (auto & i : s)
+				i = interval(i.left * factor, i.right * factor, i.left_open, i.right_open);
+			return;
+		}
+
+		auto mirror = [factor](interval const & i) {
+			return interval(i.right * factor, i.left * factor, i.right_open, i.left_open);
+		};
+		auto l = s.begin();
+		auto r = s.end();
+		for (; r - l > 1; ++l) {
+			--r;
+			interval const x = mirror(*l);
+			*l = mirror(*r);
+			*r = x;
+		}
+		if (r - l == 1)
+			*l = mirror(*l);
+	}
+
+	namespace detail {
+		// the greatest multiple of grid not above x
+		template <typename T>
+		T floor_to(T x, T grid) {
+			if constexpr (std::is_integral_v<T>) {
+				T q = x / grid;
+				if (q * grid > x) --q;
+				return q * grid;
+			} else {
+				return std::isinf(x) ? x : std::floor(x / grid) * grid;
+			}
+		}
+
+		// the least multiple of grid not below x
+		template <typename T>
+		T ceil_to(T x, T grid) {
+			if constexpr (std::is_integral_v<T>) {
+				T q = x / grid;
+				if (q * grid < x) ++q;
+				return q * grid;
+			} else {
+				return std::isinf(x) ? x : std::ceil(x / grid) * grid;
+			}
+		}
+	}
+
+	/**
+	 * @brief Rounds the endpoints of a disjoint set of intervals outward to
+	 *        multiples of grid, coalescing intervals that come to overlap or
+	 *        touch, in a single pass.
+	 *
+	 * An endpoint that moves becomes closed; one already on the grid keeps
+	 * its openness. The result is the smallest such superset of s.
+	 *
+	 * @param s A disjoint set of intervals.
+	 * @param grid The positive grid spacing.
+	 * @return The snapped set, which is another disjoint set of intervals.
+	 */
+	template <typename Set>
+	Set snap_outward_disjoint_interval_set(Set s, interval_value_type<Set> grid) {
+		using interval = interval_type<Set>;
+
+		auto j = s.begin();
+		for (auto const & i : s) {
+			auto const l = detail::floor_to(i.left, grid);
+			auto const r = detail::ceil_to(i.right, grid);
+			interval const x(l, r, l == i.left && i.left_open, r == i.right && i.right_open);
+			j = detail::push_coalesced(s, j, x);
+		}
+		s.erase(j, s.end());
+		return s;
+	}
+
+	/**
+	 * @brief Rounds the endpoints of a disjoint set of intervals inward to
+	 *        multiples of grid, dropping intervals that vanish, in a single
+	 *        pass.
+	 *
+	 * An endpoint that moves becomes closed; one already on the grid keeps
+	 * its openness. The result is the largest such subset of s.
+	 *
+	 * @param s A disjoint set of intervals.
+	 * @param grid The positive grid spacing.
+	 * @return The snapped set, which is another disjoint set of intervals.
+	 */
+	template <typename Set>
+	Set snap_inward_disjoint_interval_set(Set s, interval_value_type<Set> grid) {
+		using interval = interval_type<Set>;
+
+		auto j = s.begin();
+		for (auto const & i : s) {
+			auto const l = detail::ceil_to(i.left, grid);
+			auto const r = detail::floor_to(i.right, grid);
+			interval const x(l, r, l == i.left && i.left_open, r == i.right && i.right_open);
+			if (!detail::vacuous(x))
+				*j++ = x;
+		}
+		s.erase(j, s.end());
+		return s;
+	}
+
+	namespace detail {
+		/**
+		 * The sweep behind merge_disjoint_interval_sets, over any number of
+		 * canonical ranges, each given as a (first, last) pair. keep is
+		 * called with one flag per range.
+		 */
+		template <typename Keep, typename Emit, typename It, typename... Its>
+		void boolean_sweep(Keep keep, Emit emit, std::pair<It, It> range,
+		                   std::pair<Its, Its>... ranges) {
+			using interval = std::decay_t<decltype(*range.first)>;
+			using value_type = typename interval::value_type;
+			using key = std::pair<value_type, int>;
+			constexpr std::size_t n = 1 + sizeof...(Its);
+
+			auto rs = std::make_tuple(range, ranges...);
+			std::array<bool, n> in{};
+			auto each = [&](auto f) {
+				[&]<std::size_t... k>(std::index_sequence<k...>) {
+					(f(std::get<k>(rs), in[k]), ...);
+				}(std::make_index_sequence<n>{});
+			};
+			auto next = [](auto const & i, bool inside) {
+				return inside ? key(i->right, i->right_open ? 0 : 1)
+				              : key(i->left, i->left_open ? 1 : 0);
+			};
+
+			bool on = false;
+			key start{};
+			for (;;) {
+				bool more = false;
+				key at{};
+				each([&](auto const & r, bool inside) {
+					if (r.first == r.second) return;
+					auto const k = next(r.first, inside);
+					if (!more || k < at) at = k;
+					more = true;
+				});
+				if (!more) break;
+
+				// apply every range's endpoint at this position before testing keep
+				each([&](auto & r, bool & inside) {
+					if (r.first == r.second || next(r.first, inside) != at) return;
+					if (inside) ++r.first;
+					inside = !inside;
+				});
+
+				bool const now = std::apply(keep, in);
+				if (!on && now) {
+					start = at;
+				} else if (on && !now) {
+					emit(interval(start.first, at.first, start.second == 1, at.second == 0));
+				}
+				on = now;
+			}
+		}
+	}
+
+	/**
+	 * @brief Combines two disjoint sets of intervals with a Boolean operation
+	 *        in one streaming pass, emitting the result in canonical order.
+	 *
+	 * Both inputs are walked once, front to back, through input iterators,
+	 * and nothing is buffered, so they may be far larger than memory. The
+	 * endpoints are ordered as in at_least_k_disjoint_interval_sets, and a
+	 * region of the result starts or ends wherever keep(in_first, in_second)
+	 * changes. With keep = or, and, and and-not this is the union, the
+	 * intersection and the difference.
+	 *
+	 * @param first1, last1 A disjoint set of intervals, in canonical order.
+	 * @param first2, last2 A disjoint set of intervals, in canonical order.
+	 * @param keep Whether a point in the first set, the second, or both
+	 *             belongs to the result; keep(false, false) must be false.
+	 * @param emit Called with each interval of the result, in order.
+	 */
+	template <typename It1, typename It2, typename Keep, typename Emit>
+	void merge_disjoint_interval_sets(It1 first1, It1 last1, It2 first2, It2 last2,
+	                                  Keep keep, Emit emit) {
+		detail::boolean_sweep(std::move(keep), std::move(emit),
+		                      std::make_pair(first1, last1), std::make_pair(first2, last2));
+	}
 }
@@ -0,0 +1,235 @@
+#pragma once
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace disjoint_interval_set {
+  /**
+   * How the pages behind a large allocation are backed.
+   */
+  enum class page_mode {
+    normal,           // the default page size
+    transparent_huge, // 2 MB aligned and advised with MADV_HUGEPAGE
+    explicit_huge     // MAP_HUGETLB from the reserved pool, else transparent
+  };
+
+  /**
+   * Where the pages of a large allocation are placed on a NUMA machine.
+   */
+  enum class numa_policy {
+    first_touch, // the kernel default: the node of the first writer
+    local,       // the node of the allocating thread
+    interleave,  // round-robin over the nodes in the mask
+    bind         // only the nodes in the mask
+  };
+
+  /**
+   * The options of a huge_page_allocator.
+   */
+  struct huge_page_options {
+    page_mode pages = page_mode::transparent_huge;
+    numa_policy placement = numa_policy::first_touch;
+    std::uint64_t nodes = 0; // bit i selects node i, for interleave and bind
+  };
+
+  /**
+   * What the huge_page_allocators of a process have done with the blocks
+   * they mapped directly.
+   */
+  struct huge_page_statistics {
+    std::uint64_t mapped = 0;             // blocks mapped directly
+    std::uint64_t explicit_huge = 0;      // of which from the MAP_HUGETLB pool
+    std::uint64_t placed = 0;             // blocks placed as asked
+    std::uint64_t placement_failures = 0; // blocks left on first touch instead
+    int last_placement_error = 0;         // the errno of the last failure
+  };
+
+  namespace detail {
+    inline constexpr std::size_t huge_page_size = std::size_t(2) << 20;
+
+    // smaller blocks come from operator new; huge pages would waste them
+    inline constexpr std::size_t huge_page_threshold = std::size_t(1) << 20;
+
+    struct huge_page_counters {
+      std::atomic<std::uint64_t> mapped{0};
+      std::atomic<std::uint64_t> explicit_huge{0};
+      std::atomic<std::uint64_t> placed{0};
+      std::atomic<std::uint64_t> placement_failures{0};
+      std::atomic<int> last_placement_error{0};
+    };
+
+    inline huge_page_counters & huge_page_stats() {
+      static huge_page_counters c;
+      return c;
+    }
+
+    inline std::size_t round_to_huge_page(std::size_t bytes) {
+      return (bytes + huge_page_size - 1) / huge_page_size * huge_page_size;
+    }
+
+#ifdef __linux__
+    // maps bytes, a multiple of the huge page size, at a huge page boundary
+    inline void * map_huge(std::size_t bytes, huge_page_options const & o) {
+#ifdef MAP_HUGETLB
+      if (o.pages == page_mode::explicit_huge) {
+        void * p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED) {
+          ++huge_page_stats().mapped;
+          ++huge_page_stats().explicit_huge;
+          return p;
+        }
+      }
+#endif
+      // over-map by one huge page and trim both ends to align
+      auto const span = bytes + huge_page_size;
+      void * raw = mmap(nullptr, span, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if (raw == MAP_FAILED) return nullptr;
+      auto const at = reinterpret_cast<std::uintptr_t>(raw);
+      auto const aligned = (at + huge_page_size - 1) / huge_page_size * huge_page_size;
+      if (aligned != at)
+        munmap(raw, aligned - at);
+      if (auto const tail = at + span - (aligned + bytes); tail != 0)
+        munmap(reinterpret_cast<void *>(aligned + bytes), tail);
+
+      auto * p = reinterpret_cast<void *>(aligned);
+#ifdef MADV_HUGEPAGE
+      if (o.pages != page_mode::normal)
+        madvise(p, bytes, MADV_HUGEPAGE);
+#endif
+      ++huge_page_stats().mapped;
+      return p;
+    }
+
+    inline void placement_failed(int error) {
+      ++huge_page_stats().placement_failures;
+      huge_page_stats().last_placement_error = error;
+    }
+
+    // applies the placement before the pages are first touched; where the
+    // kernel refuses it the default placement stands, and the failure is
+    // counted in huge_page_statistics
+    inline void place(void * p, std::size_t bytes, huge_page_options const & o) {
+      if (o.placement == numa_policy::first_touch) return;
+#ifdef SYS_mbind
+      // the values of MPOL_* in <linux/mempolicy.h>
+      int mode = 0;
+      switch (o.placement) {
+        case numa_policy::first_touch: return;
+        case numa_policy::local: mode = 4; break;
+        case numa_policy::interleave: mode = 3; break;
+        case numa_policy::bind: mode = 2; break;
+      }
+      auto const mask = o.placement == numa_policy::local ? 0 : o.nodes;
+      // interleave and bind need at least one node
+      if (mask == 0 && o.placement != numa_policy::local)
+        return placement_failed(EINVAL);
+      // the kernel reads maxnode - 1 bits of the mask
+      if (syscall(SYS_mbind, p, bytes, mode, mask == 0 ? nullptr : &mask,
+                  mask == 0 ? 0 : sizeof(mask) * 8 + 1, 0) != 0)
+        return placement_failed(errno);
+      ++huge_page_stats().placed;
+#else
+      (void)p;
+      (void)bytes;
+      placement_failed(ENOSYS);
+#endif
+    }
+#endif
+  }
+
+  /**
+   * A standard allocator for the buffers of very large sets, such as
+   * std::vector<I, huge_page_allocator<I>> or the storage of a
+   * disjoint_interval_set<I, huge_page_allocator<I>>.
+   *
+   * Blocks of 1 MB and more are mapped directly, rounded up to 2 MB and
+   * aligned to it, so the kernel can back them with huge pages: either
+   * transparently, or from the explicitly reserved pool, falling back to
+   * transparent pages when the pool is empty. One huge page spans 512
+   * small ones, which cuts TLB misses on random access over tens of GB.
+   *
+   * On NUMA machines the block can also be placed on the node of the
+   * allocating thread, interleaved across nodes, or bound to some of them
+   * with mbind. Placement is best effort: where the kernel refuses it, or
+   * interleave or bind is asked for with no nodes, the pages are placed on
+   * first touch as usual and statistics() counts the failure.
+   *
+   * Smaller blocks, and every block on platforms other than Linux, come
+   * from operator new. Any two instances can free each other's memory.
+   */
+  template <typename T>
+  class huge_page_allocator {
+  public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::true_type;
+
+    huge_page_allocator() = default;
+    explicit huge_page_allocator(huge_page_options o) : o_(o) {}
+
+    template <typename U>
+    huge_page_allocator(huge_page_allocator<U> const & other) : o_(other.options()) {}
+
+    T * allocate(std::size_t n) {
+      auto const bytes = n * sizeof(T);
+#ifdef __linux__
+      if (bytes >= detail::huge_page_threshold) {
+        auto const size = detail::round_to_huge_page(bytes);
+        void * p = detail::map_huge(size, o_);
+        if (!p) throw std::bad_alloc();
+        detail::place(p, size, o_);
+        return static_cast<T *>(p);
+      }
+#endif
+      return static_cast<T *>(::operator new(bytes, std::align_val_t(alignof(T))));
+    }
+
+    void deallocate(T * p, std::size_t n) {
+      auto const bytes = n * sizeof(T);
+#ifdef __linux__
+      if (bytes >= detail::huge_page_threshold) {
+        munmap(p, detail::round_to_huge_page(bytes));
+        return;
+      }
+#endif
+      ::operator delete(p, std::align_val_t(alignof(T)));
+    }
+
+    huge_page_options options() const { return o_; }
+
+    /**
+     * @brief What all the huge_page_allocators of the process have done so
+     *        far with the blocks they mapped directly.
+     */
+    static huge_page_statistics statistics() {
+      auto const & c = detail::huge_page_stats();
+      huge_page_statistics s;
+      s.mapped = c.mapped;
+      s.explicit_huge = c.explicit_huge;
+      s.placed = c.placed;
+      s.placement_failures = c.placement_failures;
+      s.last_placement_error = c.last_placement_error;
+      return s;
+    }
+
+    template <typename U>
+    bool operator==(huge_page_allocator<U> const &) const { return true; }
+
+  private:
+    huge_page_options o_;
+  };
+}
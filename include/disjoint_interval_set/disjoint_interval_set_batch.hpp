@@ -0,0 +1,99 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+namespace disjoint_interval_set {
+  namespace detail {
+    template <typename T>
+    inline void prefetch(T const * p) {
+#if defined(__GNUC__) || defined(__clang__)
+      __builtin_prefetch(p);
+#else
+      (void)p;
+#endif
+    }
+  }
+
+  /**
+   * @brief Locates many points in a canonical set at once, overlapping
+   *        the cache misses of independent searches.
+   *
+   * A lone binary search over a set larger than the last-level cache
+   * stalls on memory at almost every probe, and each probe depends on the
+   * one before it. Here the queries are taken G at a time and their
+   * branch-free binary searches advance in lockstep, one probe each per
+   * round; searches over the same array halve the same range, so they stay
+   * aligned. After a search takes its step, the interval it probes next is
+   * prefetched, and the other G - 1 searches run before it is read. Up to G
+   * misses are in flight instead of one.
+   *
+   * Costs O(m log n) comparisons, like m binary searches, and needs no
+   * ordering of the queries.
+   *
+   * @param first, last A random-access range of canonical intervals.
+   * @param queries The m points to locate.
+   * @param out Receives, for each query in order, the position of the
+   *            interval containing it, or n if there is none.
+   */
+  template <std::size_t G = 16, typename RandomIt, typename T, typename OutIt>
+  OutIt batch_locate(RandomIt first, RandomIt last, T const * queries,
+                     std::size_t m, OutIt out) {
+    static_assert(G > 0, "the group must hold at least one search");
+    auto const n = static_cast<std::size_t>(last - first);
+    if (n == 0) {
+      for (std::size_t i = 0; i < m; ++i) *out++ = n;
+      return out;
+    }
+
+    std::size_t base[G]{};
+    for (std::size_t i = 0; i < m; i += G) {
+      auto const g = std::min(G, m - i);
+      auto const * const q = queries + i;
+      for (std::size_t k = 0; k < g; ++k) base[k] = 0;
+
+      // each round halves len for the whole group: base + half is probed,
+      // then the next probe of the same search is prefetched
+      for (auto len = n; len > 1; ) {
+        auto const half = len / 2;
+        len -= half;
+        for (std::size_t k = 0; k < g; ++k) {
+          auto const b = base[k];
+          base[k] = q[k] < first[b + half].left ? b : b + half;
+          detail::prefetch(std::addressof(first[base[k] + len / 2]));
+        }
+      }
+
+      for (std::size_t k = 0; k < g; ++k)
+        *out++ = first[base[k]].contains(q[k]) ? base[k] : n;
+    }
+    return out;
+  }
+
+  /**
+   * @brief The positions of the intervals of s containing each query, or
+   *        s.size() where there is none, using batch_locate().
+   */
+  template <std::size_t G = 16, typename Set, typename Queries>
+  std::vector<std::size_t> batch_locate(Set const & s, Queries const & queries) {
+    std::vector<std::size_t> out(std::size(queries));
+    batch_locate<G>(std::begin(s), std::end(s), std::data(queries), out.size(), out.begin());
+    return out;
+  }
+
+  /**
+   * @brief Whether s contains each query, as 0 or 1, using batch_locate().
+   */
+  template <std::size_t G = 16, typename Set, typename Queries>
+  std::vector<std::uint8_t> batch_contains(Set const & s, Queries const & queries) {
+    auto const n = static_cast<std::size_t>(std::distance(std::begin(s), std::end(s)));
+    auto const at = batch_locate<G>(s, queries);
+    std::vector<std::uint8_t> out(at.size());
+    for (std::size_t i = 0; i < at.size(); ++i) out[i] = at[i] != n;
+    return out;
+  }
+}
@@ -0,0 +1,272 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include "disjoint_interval_set.hpp"
+#include "disjoint_interval_set_hash.hpp"
+
+namespace disjoint_interval_set {
+  /**
+   * The operators a result_cache memoizes.
+   */
+  enum class set_operator : std::uint8_t {
+    unite,                // a + b
+    intersect,            // a * b
+    subtract,             // a - b
+    symmetric_difference, // a ^ b
+    complement            // ~a
+  };
+
+  /**
+   * An immutable set shared between a result_cache and its callers, with
+   * its fingerprint computed once.
+   */
+  template <typename Set>
+  struct cached_set {
+    std::shared_ptr<Set const> set;
+    std::uint64_t fingerprint = 0;
+
+    Set const & operator*() const { return *set; }
+    Set const * operator->() const { return set.get(); }
+  };
+
+  namespace detail {
+    // a set whose results a result_cache can size and trim
+    template <typename Set, typename = void>
+    struct cacheable_set : std::false_type {};
+
+    template <typename Set>
+    struct cacheable_set<Set, std::void_t<
+      decltype(std::declval<Set const &>().memory_usage().heap_bytes),
+      decltype(std::declval<Set &>().shrink_to_fit())>> : std::true_type {};
+  }
+
+  struct result_cache_statistics {
+    std::uint64_t hits = 0;
+    std::uint64_t misses = 0;
+    std::uint64_t evictions = 0;
+    std::uint64_t collisions = 0; // hits refused by verify_hits
+    std::size_t entries = 0;
+    std::size_t bytes = 0;
+  };
+
+  /**
+   * An opt-in memo of the results of set operations, for workloads that
+   * combine the same operands over and over.
+   *
+   * Operands are cached_set handles, so a lookup is keyed by the operator
+   * and the fingerprints of its operands and costs O(1) whatever their
+   * size. Results are handles too: a nested expression such as
+   * c.intersect(c.unite(a, b), c.complement(d)) is memoized node by node,
+   * and once every node has been seen it is answered by as many lookups
+   * as it has operators, with no set work at all. The operands of the
+   * commutative operators are ordered by fingerprint, so a + b and b + a
+   * share an entry.
+   *
+   * Results are held until the bytes they occupy exceed the budget, and
+   * then evicted least recently used first; a result larger than the
+   * whole budget is returned but not kept. Evicting a result does not
+   * invalidate the handles callers hold to it.
+   *
+   * Two different operands share an entry only if their fingerprints
+   * collide, with probability about 2^-64 per pair. An entry remembers its
+   * operands without keeping them alive, and with verify_hits a hit is
+   * served only once they compare equal to the operands asked about: a
+   * debugging aid that costs a comparison of the sets per hit. A hit whose
+   * operands differ is counted as a collision and computed afresh; one
+   * whose operands have since been freed is recomputed too.
+   *
+   * Set is disjoint_interval_set<I, A>, or any set type with the same
+   * operators, ==, memory_usage() and shrink_to_fit(), which the budget
+   * relies on. A cache must not be used from several threads at once.
+   */
+  template <typename Set>
+  class result_cache {
+    static_assert(detail::cacheable_set<Set>::value,
+                  "result_cache needs Set::memory_usage() and Set::shrink_to_fit()");
+
+  public:
+    using set_type = Set;
+    using handle = cached_set<Set>;
+
+    explicit result_cache(std::size_t budget_bytes = std::size_t(64) << 20,
+                          bool verify_hits = false) :
+      budget_(budget_bytes), verify_(verify_hits) {}
+
+    /**
+     * @brief Wraps a set as an operand, computing its fingerprint.
+     */
+    static handle operand(Set s) {
+      auto const fp = ::disjoint_interval_set::fingerprint(s);
+      return handle{std::make_shared<Set const>(std::move(s)), fp};
+    }
+
+    handle unite(handle const & a, handle const & b) {
+      return apply(set_operator::unite, a, b);
+    }
+
+    handle intersect(handle const & a, handle const & b) {
+      return apply(set_operator::intersect, a, b);
+    }
+
+    handle subtract(handle const & a, handle const & b) {
+      return apply(set_operator::subtract, a, b);
+    }
+
+    handle symmetric_difference(handle const & a, handle const & b) {
+      return apply(set_operator::symmetric_difference, a, b);
+    }
+
+    handle complement(handle const & a) {
+      return apply(set_operator::complement, a, a);
+    }
+
+    /**
+     * @brief The result of op on a and b (b is ignored for complement),
+     *        from the cache or computed and cached.
+     */
+    handle apply(set_operator op, handle const & a, handle const & b) {
+      auto const k = make_key(op, a, b);
+      auto it = index_.find(k);
+      if (it != index_.end() && (!verify_ || same_operands(*it->second, op, a, b))) {
+        ++stats_.hits;
+        lru_.splice(lru_.begin(), lru_, it->second);
+        return it->second->result;
+      }
+      ++stats_.misses;
+
+      auto r = compute(op, *a, *b);
+      r.shrink_to_fit();
+      auto const cost = entry_bytes(r);
+      auto h = operand(std::move(r));
+      if (it != index_.end()) {
+        // verify_hits refused the entry: keep it for the operands it has
+        if (!it->second->a.expired() && !it->second->b.expired()) {
+          ++stats_.collisions;
+          return h;
+        }
+        drop(it->second);
+      }
+      if (cost > budget_) return h;
+
+      while (stats_.bytes + cost > budget_) evict();
+      lru_.push_front(entry{k, h, a.set, b.set, cost});
+      index_.emplace(k, lru_.begin());
+      stats_.bytes += cost;
+      ++stats_.entries;
+      return h;
+    }
+
+    result_cache_statistics statistics() const { return stats_; }
+    std::size_t budget() const { return budget_; }
+    bool verify_hits() const { return verify_; }
+    void set_verify_hits(bool on) { verify_ = on; }
+
+    /**
+     * @brief Changes the budget, evicting results until it is met.
+     */
+    void set_budget(std::size_t budget_bytes) {
+      budget_ = budget_bytes;
+      while (stats_.bytes > budget_) evict();
+    }
+
+    void clear() {
+      index_.clear();
+      lru_.clear();
+      stats_.entries = 0;
+      stats_.bytes = 0;
+    }
+
+  private:
+    struct key {
+      std::uint64_t a;
+      std::uint64_t b;
+      set_operator op;
+
+      bool operator==(key const & o) const { return a == o.a && b == o.b && op == o.op; }
+    };
+
+    struct key_hash {
+      std::size_t operator()(key const & k) const {
+        return static_cast<std::size_t>(detail::fmix64(
+          k.a ^ detail::fmix64(k.b + static_cast<std::uint64_t>(k.op))));
+      }
+    };
+
+    struct entry {
+      key k;
+      handle result;
+      // the operands, for verify_hits
+      std::weak_ptr<Set const> a;
+      std::weak_ptr<Set const> b;
+      std::size_t bytes;
+    };
+
+    using lru_list = std::list<entry>;
+
+    std::size_t budget_;
+    bool verify_;
+    lru_list lru_;
+    std::unordered_map<key, typename lru_list::iterator, key_hash> index_;
+    result_cache_statistics stats_;
+
+    static key make_key(set_operator op, handle const & a, handle const & b) {
+      switch (op) {
+        case set_operator::complement:
+          return key{a.fingerprint, 0, op};
+        case set_operator::subtract:
+          return key{a.fingerprint, b.fingerprint, op};
+        default:
+          // the other operators commute
+          return a.fingerprint < b.fingerprint ? key{a.fingerprint, b.fingerprint, op} :
+                                                 key{b.fingerprint, a.fingerprint, op};
+      }
+    }
+
+    static bool same_operands(entry const & e, set_operator op,
+                              handle const & a, handle const & b) {
+      auto const ea = e.a.lock(), eb = e.b.lock();
+      if (!ea || !eb) return false;
+      auto same = [](auto const & x, handle const & y) { return x == y.set || *x == *y; };
+      if (same(ea, a) && (op == set_operator::complement || same(eb, b)))
+        return true;
+      // the commutative operators may have stored the operands swapped
+      return op != set_operator::complement && op != set_operator::subtract &&
+             same(ea, b) && same(eb, a);
+    }
+
+    static Set compute(set_operator op, Set const & a, Set const & b) {
+      switch (op) {
+        case set_operator::unite: return a + b;
+        case set_operator::intersect: return a * b;
+        case set_operator::subtract: return a - b;
+        case set_operator::symmetric_difference: return a ^ b;
+        case set_operator::complement: break;
+      }
+      return ~a;
+    }
+
+    // the heap bytes of a result plus its share of the bookkeeping
+    static std::size_t entry_bytes(Set const & r) {
+      return r.memory_usage().heap_bytes + sizeof(Set) +
+             sizeof(entry) + 4 * sizeof(void *) + sizeof(std::pair<key const, void *>);
+    }
+
+    void drop(typename lru_list::iterator e) {
+      stats_.bytes -= e->bytes;
+      --stats_.entries;
+      index_.erase(e->k);
+      lru_.erase(e);
+    }
+
+    void evict() {
+      ++stats_.evictions;
+      drop(std::prev(lru_.end()));
+    }
+  };
+}
@@ -0,0 +1,270 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "disjoint_interval_set.hpp"
+#include "disjoint_interval_set_file.hpp"
+
+namespace disjoint_interval_set {
+  /**
+   * @brief Writes the intervals of a canonical set to path atomically, in
+   *        the interval file format.
+   *
+   * The set goes to a temporary file next to path, which is flushed to
+   * stable storage and then renamed over path, and the directory entry is
+   * flushed in turn. A crash at any point leaves either the old file or
+   * the complete new one, never a mix. The temporary file has a name of
+   * its own from mkstemp, so checkpoints to the same path from several
+   * threads or processes do not write over each other's; the last rename
+   * wins. It is written through the descriptor mkstemp returns and never
+   * reopened by name.
+   *
+   * @return The number of intervals written.
+   * @throws std::invalid_argument if page_bytes is out of range, before
+   *         anything is written.
+   */
+  template <typename Set>
+  std::uint64_t checkpoint(Set const & s, std::string const & path,
+                           std::size_t page_bytes = 16384) {
+    using interval = std::decay_t<decltype(*std::begin(s))>;
+
+    // reject a bad page size before anything is created
+    detail::records_per_page<typename interval::value_type>(page_bytes);
+    auto tmp = path + ".tmp.XXXXXX";
+    detail::file_descriptor fd(::mkostemp(tmp.data(), O_CLOEXEC));
+    if (fd.get() == -1) detail::throw_errno("mkstemp " + tmp);
+    std::uint64_t n = 0;
+    try {
+      // mkstemp creates the file private to its owner; give it the mode
+      // interval_file_writer would
+      if (::fchmod(fd.get(), 0644) != 0) detail::throw_errno("fchmod " + tmp);
+      interval_file_writer<interval> w(std::move(fd), tmp, page_bytes);
+      w.push(std::begin(s), std::end(s));
+      n = w.finish(true);
+    } catch (...) {
+      ::unlink(tmp.c_str());
+      throw;
+    }
+    if (::rename(tmp.c_str(), path.c_str()) != 0) {
+      auto const e = errno;
+      ::unlink(tmp.c_str());
+      errno = e;
+      detail::throw_errno("rename " + tmp);
+    }
+
+    auto const slash = path.find_last_of('/');
+    auto const dir = slash == std::string::npos ? std::string(".") :
+      slash == 0 ? std::string("/") : path.substr(0, slash);
+    detail::file_descriptor(dir, O_RDONLY | O_DIRECTORY).sync();
+    return n;
+  }
+
+  /**
+   * A read-only disjoint interval set mapped from a file in the interval
+   * file format, as restore() returns it.
+   *
+   * Opening maps the file and checks the header and the fences, which is
+   * cheap; the intervals are decoded in place from the mapped pages, and
+   * nothing is read until it is touched. Each page is checked against its
+   * checksum the first time it is accessed, so a restart does not pay to
+   * validate the whole set up front. A corrupt page raises
+   * std::runtime_error when it is reached; validate() checks them all.
+   *
+   * Lookups may run from several threads at once.
+   */
+  template <typename I>
+  class mapped_interval_set {
+  public:
+    using interval_type = I;
+    using value_type = typename I::value_type;
+
+    /**
+     * Walks the intervals in order, decoding each one on access.
+     */
+    class const_iterator {
+    public:
+      using iterator_category = std::input_iterator_tag;
+      using value_type = I;
+      using difference_type = std::ptrdiff_t;
+      using pointer = void;
+      using reference = I;
+
+      const_iterator() = default;
+
+      I operator*() const { return (*s_)[k_]; }
+
+      const_iterator & operator++() {
+        ++k_;
+        return *this;
+      }
+
+      const_iterator operator++(int) {
+        auto const old = *this;
+        ++k_;
+        return old;
+      }
+
+      bool operator==(const_iterator const & o) const { return k_ == o.k_; }
+      bool operator!=(const_iterator const & o) const { return k_ != o.k_; }
+
+    private:
+      friend class mapped_interval_set;
+
+      mapped_interval_set const * s_ = nullptr;
+      std::uint64_t k_ = 0;
+
+      const_iterator(mapped_interval_set const * s, std::uint64_t k) : s_(s), k_(k) {}
+    };
+
+    explicit mapped_interval_set(std::string const & path) : path_(path) {
+      detail::file_descriptor fd(path, O_RDONLY);
+      struct stat st;
+      if (::fstat(fd.get(), &st) != 0) detail::throw_errno("fstat " + path);
+      bytes_ = static_cast<std::size_t>(st.st_size);
+      if (bytes_ < sizeof(interval_file_header))
+        throw std::runtime_error(path + ": not an interval set file");
+
+      void * p = ::mmap(nullptr, bytes_, PROT_READ, MAP_SHARED, fd.get(), 0);
+      if (p == MAP_FAILED) detail::throw_errno("mmap " + path);
+      base_ = static_cast<char const *>(p);
+
+      try {
+        std::memcpy(&h_, base_, sizeof h_);
+        detail::check_header<value_type>(h_, path);
+        auto const rs = detail::record_size<value_type>();
+        auto const full = h_.pages == 0 ? 0 : (h_.pages - 1) * h_.records_per_page;
+        auto const fences_bytes = h_.pages * sizeof(value_type);
+        if (h_.intervals < full || h_.intervals - full > (h_.pages == 0 ? 0 : h_.records_per_page) ||
+            h_.fences_offset < (h_.pages + 1) * h_.page_bytes ||
+            h_.fences_offset + fences_bytes > bytes_ ||
+            interval_file_page_header + h_.records_per_page * rs > h_.page_bytes)
+          throw std::runtime_error(path + ": truncated or inconsistent file");
+
+        fences_.resize(h_.pages);
+        std::memcpy(fences_.data(), base_ + h_.fences_offset, fences_bytes);
+        if (detail::crc32(fences_.data(), fences_bytes) != h_.fences_crc)
+          throw std::runtime_error(path + ": corrupt fences");
+        checked_ = std::make_unique<std::atomic<bool>[]>(h_.pages);
+      } catch (...) {
+        ::munmap(p, bytes_);
+        throw;
+      }
+    }
+
+    mapped_interval_set(mapped_interval_set const &) = delete;
+    mapped_interval_set & operator=(mapped_interval_set const &) = delete;
+
+    mapped_interval_set(mapped_interval_set && o) noexcept :
+      path_(std::move(o.path_)), base_(o.base_), bytes_(o.bytes_), h_(o.h_),
+      fences_(std::move(o.fences_)), checked_(std::move(o.checked_)) {
+      o.base_ = nullptr;
+    }
+
+    ~mapped_interval_set() {
+      if (base_) ::munmap(const_cast<char *>(base_), bytes_);
+    }
+
+    std::uint64_t size() const { return h_.intervals; }
+    bool empty() const { return h_.intervals == 0; }
+    std::uint64_t pages() const { return h_.pages; }
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, h_.intervals); }
+
+    /**
+     * @brief The k-th interval, decoded from its page.
+     */
+    I operator[](std::uint64_t k) const {
+      auto const page = k / h_.records_per_page;
+      return detail::decode_record<I>(records(page) +
+        (k % h_.records_per_page) * detail::record_size<value_type>());
+    }
+
+    bool contains(value_type v) const {
+      auto const f = std::upper_bound(fences_.begin(), fences_.end(), v);
+      if (f == fences_.begin()) return false;
+      auto const page = static_cast<std::uint64_t>(f - fences_.begin() - 1);
+
+      // the last record in the page that starts at or before v
+      auto const * r = records(page);
+      auto const rs = detail::record_size<value_type>();
+      std::size_t lo = 0, hi = count(page);
+      while (hi - lo > 1) {
+        auto const mid = lo + (hi - lo) / 2;
+        value_type left;
+        std::memcpy(&left, r + mid * rs, sizeof left);
+        if (v < left) hi = mid;
+        else lo = mid;
+      }
+      return detail::decode_record<I>(r + lo * rs).contains(v);
+    }
+
+    /**
+     * @brief Checks every page that has not been checked yet.
+     */
+    void validate() const {
+      for (std::uint64_t k = 0; k < h_.pages; ++k) records(k);
+    }
+
+    /**
+     * @brief Copies the intervals into a set in memory from a.
+     */
+    template <typename A = std::allocator<I>>
+    disjoint_interval_set<I, A> to_set(A const & a = A()) const {
+      std::vector<I> v;
+      v.reserve(h_.intervals);
+      for (std::uint64_t k = 0; k < h_.intervals; ++k) v.push_back((*this)[k]);
+      return disjoint_interval_set<I, A>(v.begin(), v.end(), a);
+    }
+
+  private:
+    std::string path_;
+    char const * base_ = nullptr;
+    std::size_t bytes_ = 0;
+    interval_file_header h_{};
+    std::vector<value_type> fences_;
+    std::unique_ptr<std::atomic<bool>[]> checked_;
+
+    std::uint32_t count(std::uint64_t page) const {
+      std::uint32_t n;
+      std::memcpy(&n, base_ + (page + 1) * h_.page_bytes, 4);
+      return n;
+    }
+
+    // the records of a page, checked on first access
+    char const * records(std::uint64_t page) const {
+      auto const * p = base_ + (page + 1) * h_.page_bytes;
+      if (!checked_[page].load(std::memory_order_acquire)) {
+        std::uint32_t n, crc;
+        std::memcpy(&n, p, 4);
+        std::memcpy(&crc, p + 4, 4);
+        if (n == 0 || n > h_.records_per_page ||
+            detail::crc32(p + interval_file_page_header,
+                          n * detail::record_size<value_type>()) != crc)
+          throw std::runtime_error(path_ + ": corrupt page " + std::to_string(page));
+        checked_[page].store(true, std::memory_order_release);
+      }
+      return p + interval_file_page_header;
+    }
+  };
+
+  /**
+   * @brief Maps a set written by checkpoint() back into memory, without
+   *        parsing or copying it.
+   */
+  template <typename I = interval<double>>
+  mapped_interval_set<I> restore(std::string const & path) {
+    return mapped_interval_set<I>(path);
+  }
+}
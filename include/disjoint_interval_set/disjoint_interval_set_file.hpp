@@ -0,0 +1,324 @@
+#pragma once
+
+#include <array>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "disjoint_interval_set_algorithms.hpp"
+#include "interval.hpp"
+
+namespace disjoint_interval_set {
+  /**
+   * The binary file format of a disjoint interval set, shared by the paged
+   * set, external construction and checkpoints.
+   *
+   *   offset 0                  header, padded to page_bytes
+   *   offset (k + 1) page_bytes page k: count, checksum, count records
+   *   offset fences_offset      the left endpoint of the first record of
+   *                             every page, for locating pages
+   *
+   * A record is the left and right endpoints followed by one byte of flags,
+   * bit 0 for an open left end and bit 1 for an open right end. Every page
+   * carries a CRC-32 of its records, and the header one of the fences and
+   * of itself. Values are stored in the byte order of the host, which the
+   * header records.
+   */
+  struct interval_file_header {
+    char magic[8];
+    std::uint32_t byte_order;
+    std::uint32_t version;
+    std::uint32_t value_size;
+    std::uint32_t value_kind; // 0 signed, 1 unsigned, 2 floating-point
+    std::uint32_t page_bytes;
+    std::uint32_t records_per_page;
+    std::uint64_t intervals;
+    std::uint64_t pages;
+    std::uint64_t fences_offset;
+    std::uint32_t fences_crc;
+    std::uint32_t header_crc; // of all the fields before it
+  };
+
+  static_assert(sizeof(interval_file_header) == 64, "the header is 64 bytes on disk");
+
+  inline constexpr char interval_file_magic[8] = {'D', 'I', 'S', 'E', 'T', 'F', 'M', 'T'};
+  inline constexpr std::uint32_t interval_file_byte_order = 0x01020304;
+  inline constexpr std::uint32_t interval_file_version = 1;
+  inline constexpr std::size_t interval_file_page_header = 8;
+
+  namespace detail {
+    // CRC-32 (IEEE 802.3), continuing from crc
+    inline std::uint32_t crc32(void const * data, std::size_t n, std::uint32_t crc = 0) {
+      static constexpr auto table = [] {
+        std::array<std::uint32_t, 256> t{};
+        for (std::uint32_t i = 0; i < 256; ++i) {
+          auto c = i;
+          for (int k = 0; k < 8; ++k)
+            c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+          t[i] = c;
+        }
+        return t;
+      }();
+      auto const * p = static_cast<unsigned char const *>(data);
+      crc = ~crc;
+      for (std::size_t i = 0; i < n; ++i)
+        crc = table[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+      return ~crc;
+    }
+
+    [[noreturn]] inline void throw_errno(std::string const & what) {
+      throw std::system_error(errno, std::generic_category(), what);
+    }
+
+    // an owned POSIX file descriptor
+    class file_descriptor {
+    public:
+      file_descriptor() = default;
+      file_descriptor(std::string const & path, int flags, mode_t mode = 0644) :
+        fd_(::open(path.c_str(), flags | O_CLOEXEC, mode)) {
+        if (fd_ == -1) throw_errno("open " + path);
+      }
+      // takes ownership of fd, an open descriptor or -1
+      explicit file_descriptor(int fd) noexcept : fd_(fd) {}
+      file_descriptor(file_descriptor && o) noexcept : fd_(o.fd_) { o.fd_ = -1; }
+      file_descriptor & operator=(file_descriptor && o) noexcept {
+        std::swap(fd_, o.fd_);
+        return *this;
+      }
+      ~file_descriptor() { if (fd_ != -1) ::close(fd_); }
+
+      int get() const { return fd_; }
+
+      void read_at(void * buf, std::size_t n, std::uint64_t off) const {
+        auto * p = static_cast<char *>(buf);
+        while (n != 0) {
+          auto const r = ::pread(fd_, p, n, static_cast<off_t>(off));
+          if (r < 0 && errno == EINTR) continue;
+          if (r < 0) throw_errno("pread");
+          if (r == 0) throw std::runtime_error("unexpected end of file");
+          p += r;
+          n -= static_cast<std::size_t>(r);
+          off += static_cast<std::uint64_t>(r);
+        }
+      }
+
+      void write_at(void const * buf, std::size_t n, std::uint64_t off) const {
+        auto const * p = static_cast<char const *>(buf);
+        while (n != 0) {
+          auto const r = ::pwrite(fd_, p, n, static_cast<off_t>(off));
+          if (r < 0 && errno == EINTR) continue;
+          if (r < 0) throw_errno("pwrite");
+          p += r;
+          n -= static_cast<std::size_t>(r);
+          off += static_cast<std::uint64_t>(r);
+        }
+      }
+
+      void sync() const {
+        if (::fsync(fd_) != 0) throw_errno("fsync");
+      }
+
+    private:
+      int fd_ = -1;
+    };
+
+    template <typename T>
+    constexpr std::uint32_t value_kind() {
+      return std::is_floating_point_v<T> ? 2 : std::is_signed_v<T> ? 0 : 1;
+    }
+
+    template <typename T>
+    constexpr std::size_t record_size() { return 2 * sizeof(T) + 1; }
+
+    // the records a page of page_bytes holds; a page must be able to hold
+    // the header, which fills page 0, and at least one record
+    template <typename T>
+    std::size_t records_per_page(std::size_t page_bytes) {
+      if (page_bytes < sizeof(interval_file_header))
+        throw std::invalid_argument("page too small for the file header");
+      if (page_bytes > UINT32_MAX)
+        throw std::invalid_argument("page too large for the file header");
+      auto const n = (page_bytes - interval_file_page_header) / record_size<T>();
+      if (n == 0)
+        throw std::invalid_argument("page too small for one record");
+      return n;
+    }
+
+    template <typename I>
+    void encode_record(char * p, I const & x) {
+      using T = typename I::value_type;
+      std::memcpy(p, &x.left, sizeof(T));
+      std::memcpy(p + sizeof(T), &x.right, sizeof(T));
+      p[2 * sizeof(T)] = static_cast<char>((x.left_open ? 1 : 0) | (x.right_open ? 2 : 0));
+    }
+
+    template <typename I>
+    I decode_record(char const * p) {
+      using T = typename I::value_type;
+      T l, r;
+      std::memcpy(&l, p, sizeof(T));
+      std::memcpy(&r, p + sizeof(T), sizeof(T));
+      auto const f = static_cast<unsigned char>(p[2 * sizeof(T)]);
+      return I(l, r, (f & 1) != 0, (f & 2) != 0);
+    }
+
+    // checks a header read from disk against the value type it is opened as
+    template <typename T>
+    void check_header(interval_file_header const & h, std::string const & path) {
+      auto fail = [&](char const * why) {
+        throw std::runtime_error(path + ": " + why);
+      };
+      if (std::memcmp(h.magic, interval_file_magic, sizeof h.magic) != 0)
+        fail("not an interval set file");
+      if (h.byte_order != interval_file_byte_order) fail("foreign byte order");
+      if (h.header_crc != crc32(&h, offsetof(interval_file_header, header_crc)))
+        fail("corrupt header");
+      if (h.version != interval_file_version) fail("unsupported version");
+      if (h.value_size != sizeof(T) || h.value_kind != value_kind<T>())
+        fail("stored values do not match the value type");
+      if (h.records_per_page == 0 || h.page_bytes < sizeof(interval_file_header) ||
+          h.page_bytes < interval_file_page_header + h.records_per_page * record_size<T>())
+        fail("bad page geometry");
+    }
+  }
+
+  /**
+   * Writes a disjoint interval set to a file in the interval file format,
+   * one page at a time, in O(page_bytes) memory.
+   *
+   * Intervals must arrive ordered by left endpoint, as std::sort leaves
+   * them, but may overlap or touch: each one is coalesced with the last
+   * before it is written, so the file is always canonical.
+   */
+  template <typename I>
+  class interval_file_writer {
+  public:
+    using interval_type = I;
+    using value_type = typename I::value_type;
+
+    /**
+     * @brief Creates or truncates the file at path.
+     *
+     * @param page_bytes The size of a page, at least the 64 bytes of the
+     *                   header, which holds
+     *                   (page_bytes - 8) / (2 sizeof(value_type) + 1) records.
+     * @throws std::invalid_argument if page_bytes is out of range, before
+     *         the file is touched.
+     */
+    explicit interval_file_writer(std::string const & path, std::size_t page_bytes = 16384) :
+      path_(path),
+      page_bytes_(page_bytes),
+      per_page_(detail::records_per_page<value_type>(page_bytes)),
+      fd_(path, O_WRONLY | O_CREAT | O_TRUNC),
+      page_(page_bytes, 0) {}
+
+    /**
+     * @brief Writes through fd, an empty file already open for writing,
+     *        such as one mkstemp created; path only names it in messages.
+     */
+    interval_file_writer(detail::file_descriptor fd, std::string const & path,
+                         std::size_t page_bytes = 16384) :
+      path_(path),
+      page_bytes_(page_bytes),
+      per_page_(detail::records_per_page<value_type>(page_bytes)),
+      fd_(std::move(fd)),
+      page_(page_bytes, 0) {}
+
+    interval_file_writer(interval_file_writer &&) = default;
+
+    /**
+     * @brief Appends x, which starts no earlier than the last interval.
+     */
+    void push(I const & x) {
+      if (detail::vacuous(x)) return;
+      if (has_tail_ && detail::mergeable(tail_, x)) {
+        tail_ = detail::hull(tail_, x);
+        return;
+      }
+      if (has_tail_) put(tail_);
+      tail_ = x;
+      has_tail_ = true;
+    }
+
+    template <typename It>
+    void push(It first, It last) {
+      for (; first != last; ++first) push(*first);
+    }
+
+    /**
+     * @brief Writes the last page, the fences and the header. With sync,
+     *        the file is also flushed to stable storage before returning.
+     *
+     * @return The number of intervals written.
+     */
+    std::uint64_t finish(bool sync = false) {
+      if (has_tail_) put(tail_);
+      has_tail_ = false;
+      if (count_ != 0) flush();
+
+      auto const fences_offset = (pages_ + 1) * page_bytes_;
+      fd_.write_at(fences_.data(), fences_.size() * sizeof(value_type), fences_offset);
+
+      interval_file_header h{};
+      std::memcpy(h.magic, interval_file_magic, sizeof h.magic);
+      h.byte_order = interval_file_byte_order;
+      h.version = interval_file_version;
+      h.value_size = sizeof(value_type);
+      h.value_kind = detail::value_kind<value_type>();
+      h.page_bytes = static_cast<std::uint32_t>(page_bytes_);
+      h.records_per_page = static_cast<std::uint32_t>(per_page_);
+      h.intervals = intervals_;
+      h.pages = pages_;
+      h.fences_offset = fences_offset;
+      h.fences_crc = detail::crc32(fences_.data(), fences_.size() * sizeof(value_type));
+      h.header_crc = detail::crc32(&h, offsetof(interval_file_header, header_crc));
+      fd_.write_at(&h, sizeof h, 0);
+      if (sync) fd_.sync();
+      return intervals_;
+    }
+
+    std::string const & path() const { return path_; }
+
+  private:
+    std::string path_;
+    std::size_t page_bytes_;
+    std::size_t per_page_;
+    detail::file_descriptor fd_;
+    std::vector<char> page_;
+    std::vector<value_type> fences_;
+    std::uint32_t count_ = 0;
+    std::uint64_t pages_ = 0;
+    std::uint64_t intervals_ = 0;
+    I tail_{};
+    bool has_tail_ = false;
+
+    void put(I const & x) {
+      if (count_ == 0) fences_.push_back(x.left);
+      detail::encode_record(page_.data() + interval_file_page_header +
+                            count_ * detail::record_size<value_type>(), x);
+      ++intervals_;
+      if (++count_ == per_page_) flush();
+    }
+
+    void flush() {
+      auto const used = count_ * detail::record_size<value_type>();
+      auto const crc = detail::crc32(page_.data() + interval_file_page_header, used);
+      std::memcpy(page_.data(), &count_, 4);
+      std::memcpy(page_.data() + 4, &crc, 4);
+      std::memset(page_.data() + interval_file_page_header + used, 0,
+                  page_bytes_ - interval_file_page_header - used);
+      fd_.write_at(page_.data(), page_bytes_, (pages_ + 1) * page_bytes_);
+      ++pages_;
+      count_ = 0;
+    }
+  };
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include "disjoint_interval_set.hpp"
+
+namespace disjoint_interval_set {
+  namespace detail {
+    // the finalizer of MurmurHash3, a bijection that mixes every input bit
+    // into every output bit
+    inline std::uint64_t fmix64(std::uint64_t h) {
+      h ^= h >> 33;
+      h *= 0xff51afd7ed558ccdULL;
+      h ^= h >> 33;
+      h *= 0xc4ceb9fe1a85ec53ULL;
+      h ^= h >> 33;
+      return h;
+    }
+
+    // the bits of a value, with the two zeros of floating-point types
+    // folded together since they compare equal
+    template <typename T>
+    std::uint64_t value_bits(T v) {
+      if constexpr (std::is_floating_point_v<T>) v += T(0);
+      if constexpr (sizeof(T) <= sizeof(std::uint64_t) && std::is_trivially_copyable_v<T> &&
+                    !std::is_same_v<T, long double>) {
+        std::uint64_t b = 0;
+        std::memcpy(&b, &v, sizeof v);
+        return b;
+      } else {
+        return std::hash<T>{}(v);
+      }
+    }
+
+    // the hash of one interval, independent of every other
+    template <typename I>
+    std::uint64_t interval_hash(I const & x) {
+      auto const flags = std::uint64_t((x.left_open ? 1 : 0) | (x.right_open ? 2 : 0));
+      auto const r = fmix64(value_bits(x.right) ^ ((flags + 1) * 0x9e3779b97f4a7c15ULL));
+      return fmix64(value_bits(x.left) + r * 0xbf58476d1ce4e5b9ULL);
+    }
+  }
+
+  /**
+   * @brief A 64-bit fingerprint of a canonical range of intervals.
+   *
+   * The fingerprint is the sum, modulo 2^64, of a strong hash of each
+   * interval. Equal sequences of intervals have equal fingerprints, and two
+   * different ones collide with probability about 2^-64, so comparing
+   * fingerprints first rules out almost all unequal pairs without comparing
+   * intervals. The intervals are hashed as written: [1,2], [3,4] and [1,4]
+   * hold the same integers but fingerprint differently.
+   *
+   * The per-interval hashes do not depend on one another, so the loop
+   * carries no dependency but the sum, and the hashes of neighbouring
+   * intervals are computed in parallel. Because the sum is homomorphic, a
+   * set that changes a few intervals at a time can keep its fingerprint up
+   * to date by subtracting the hashes of the intervals it removes and
+   * adding those of the ones it adds, and the result equals the
+   * fingerprint of the canonical set computed from scratch; see
+   * adaptive_interval_set::fingerprint() and
+   * windowed_interval_set::fingerprint().
+   */
+  template <typename Set>
+  std::uint64_t fingerprint(Set const & s) {
+    std::uint64_t h = 0;
+    for (auto const & x : s) h += detail::interval_hash(x);
+    return h;
+  }
+}
+
+/**
+ * Hashes a disjoint interval set by its fingerprint, so sets can key
+ * unordered containers.
+ */
+template <typename I, typename A>
+struct std::hash<disjoint_interval_set::disjoint_interval_set<I, A>> {
+  std::size_t operator()(disjoint_interval_set::disjoint_interval_set<I, A> const & s) const {
+    return static_cast<std::size_t>(disjoint_interval_set::fingerprint(s));
+  }
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+
+namespace disjoint_interval_set {
+  /**
+   * A snapshot of the memory a set occupies.
+   *
+   * heap_bytes is everything allocated on the heap, of which slack_bytes
+   * is reserved but unused capacity and padding_bytes is the alignment
+   * padding inside the stored intervals.
+   */
+  struct memory_footprint {
+    std::size_t intervals = 0;
+    std::size_t heap_bytes = 0;
+    std::size_t slack_bytes = 0;
+    std::size_t padding_bytes = 0;
+
+    /**
+     * @brief The heap bytes per stored interval, including slack.
+     */
+    double bytes_per_interval() const {
+      return intervals == 0 ? 0.0 : static_cast<double>(heap_bytes) / intervals;
+    }
+  };
+
+  /**
+   * @brief The bytes of an interval type that hold no data.
+   */
+  template <typename I>
+  constexpr std::size_t interval_padding() {
+    return sizeof(I) - 2 * sizeof(typename I::value_type) - 2 * sizeof(bool);
+  }
+
+  /**
+   * @brief The footprint of a contiguous container of intervals, such as
+   *        std::vector.
+   */
+  template <typename Set>
+  memory_footprint contiguous_footprint(Set const & s) {
+    using interval_type = typename Set::value_type;
+    memory_footprint m;
+    m.intervals = s.size();
+    m.heap_bytes = s.capacity() * sizeof(interval_type);
+    m.slack_bytes = (s.capacity() - s.size()) * sizeof(interval_type);
+    m.padding_bytes = s.size() * interval_padding<interval_type>();
+    return m;
+  }
+}
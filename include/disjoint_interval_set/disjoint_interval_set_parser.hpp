@@ -5,14 +5,19 @@
 #include <string>
 #include <algorithm>
 #include <regex>
+#include <charconv>
+#include <cctype>
+#include <limits>
+#include "disjoint_interval_set_trace.hpp"
 
 using std::string;
-using std::sregex_iterator;
+using std::cregex_iterator;
 using std::numeric_limits;
 using std::stringstream;
 using std::ostream;
 using std::regex;
 using std::string_view;
+using std::from_chars;
 
 namespace disjoint_interval_set {
   /**
@@ -22,6 +27,7 @@ namespace disjoint_interval_set {
   template <typename Set>
   void make_interval_set(string_view s, Set & is) {
     using interval_type = typename Set::interval_type;
+    using T = typename interval_type::value_type;
 
     const static string N = "[-+]?([0-9]*\\.?[0-9]+([eE][-+]?[0-9]+)?|inf(inity)?)";
     const static string L = "(\\(|\\[)";
@@ -30,7 +36,10 @@ namespace disjoint_interval_set {
     const static string INF = "(+|-)?inf(inity)?";
     const static regex r("(" + N + "|" + L + S + N + S + "," + S + N + S + R + ")");
 
-    for (auto i = sregex_iterator(s.begin(), s.end(), r); i != sregex_iterator(); ++i) {
+    trace_scope trace(trace_phase::parse, s.size());
+    auto const n = is.size();
+
+    for (auto i = cregex_iterator(s.data(), s.data() + s.size(), r); i != cregex_iterator(); ++i) {
       T value[2];
       bool open[2];
       T factor;
@@ -70,5 +79,101 @@ namespace disjoint_interval_set {
         is.push_back(interval_type(value[0],value[0],false,false));
       }
     }
+    trace.output(is.size() - n);
+  }
+
+  /**
+   * A hand-written single-pass parser that accepts the same encoding as
+   * make_interval_set, without the regex engine or a stringstream per
+   * token. Numbers are converted in place with std::from_chars.
+   *
+   * Characters that cannot start an interval or a number are skipped, as
+   * are bracketed tokens that turn out to be malformed. As in the regex, a
+   * '.' must be followed by a digit, so forms from_chars alone would take,
+   * like "1." or "1.e5", split into the same tokens in both parsers.
+   */
+  template <typename Set>
+  void make_interval_set_fast(string_view s, Set & is) {
+    using interval_type = typename Set::interval_type;
+    using T = typename interval_type::value_type;
+
+    trace_scope trace(trace_phase::parse, s.size());
+    auto const n = is.size();
+
+    char const * p = s.data();
+    char const * const e = p + s.size();
+
+    auto skip = [&p, e]() -> void {
+      while (p != e && *p == ' ')
+        ++p;
+    };
+
+    // parses [-+]?(number|inf(inity)?) at p; on failure p is unspecified
+    auto number = [&p, e](T & value) -> bool {
+      bool negative = false;
+      if (p != e && (*p == '+' || *p == '-'))
+        negative = (*p++ == '-');
+      if (p == e)
+        return false;
+      if (*p == 'i') {
+        if (e - p < 3 || p[1] != 'n' || p[2] != 'f')
+          return false;
+        p += 3;
+        if (e - p >= 5 && string_view(p, 5) == "inity")
+          p += 5;
+        value = numeric_limits<T>::infinity();
+      } else {
+        // the regex needs a digit after a '.', so "1." and "1.e5" are the
+        // number 1 followed by a stray '.'; from_chars would take both whole
+        char const * q = p;
+        while (q != e && isdigit(static_cast<unsigned char>(*q)))
+          ++q;
+        if (q == p && *p != '.')
+          return false;
+        auto const last = (q != e && *q == '.' &&
+                           (q + 1 == e || !isdigit(static_cast<unsigned char>(q[1])))) ? q : e;
+        auto [end, ec] = from_chars(p, last, value);
+        if (ec != std::errc())
+          return false;
+        p = end;
+      }
+      if (negative)
+        value = -value;
+      return true;
+    };
+
+    while (p != e) {
+      char const * const start = p;
+      T value[2];
+
+      if (*p == '[' || *p == '(') {
+        bool const open_left = (*p++ == '(');
+        skip();
+        if (number(value[0])) {
+          skip();
+          if (p != e && *p == ',') {
+            ++p;
+            skip();
+            if (number(value[1])) {
+              skip();
+              if (p != e && (*p == ')' || *p == ']')) {
+                is.push_back(interval_type(value[0], value[1], open_left, *p++ == ')'));
+                continue;
+              }
+            }
+          }
+        }
+        p = start + 1;
+      } else if (isdigit(static_cast<unsigned char>(*p)) ||
+                 *p == '.' || *p == '+' || *p == '-' || *p == 'i') {
+        if (number(value[0]))
+          is.push_back(interval_type(value[0], value[0], false, false));
+        else
+          p = start + 1;
+      } else {
+        ++p;
+      }
+    }
+    trace.output(is.size() - n);
   }
 }
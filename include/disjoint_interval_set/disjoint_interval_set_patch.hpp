@@ -0,0 +1,178 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "disjoint_interval_set.hpp"
+#include "disjoint_interval_set_algorithms.hpp"
+#include "disjoint_interval_set_file.hpp"
+
+namespace disjoint_interval_set {
+  /**
+   * The change from one version of a disjoint interval set to another: the
+   * regions the new version added and the ones it removed, each a
+   * canonical sequence of intervals. The two never overlap.
+   *
+   * A small change to a large set gives a small patch, so replicas can be
+   * brought up to date by shipping the patch instead of the whole set.
+   */
+  template <typename I>
+  struct interval_patch {
+    using interval_type = I;
+
+    std::vector<I> added;
+    std::vector<I> removed;
+
+    bool empty() const { return added.empty() && removed.empty(); }
+
+    /**
+     * @brief The patch that undoes this one.
+     */
+    interval_patch inverse() const { return interval_patch{removed, added}; }
+  };
+
+  /**
+   * @brief The patch that turns the canonical range old_set into new_set,
+   *        in two streaming sweeps over both, O(n + m).
+   */
+  template <typename Old, typename New>
+  auto diff(Old const & old_set, New const & new_set) {
+    using interval = std::decay_t<decltype(*std::begin(old_set))>;
+    interval_patch<interval> p;
+    merge_disjoint_interval_sets(std::begin(old_set), std::end(old_set),
+      std::begin(new_set), std::end(new_set),
+      [](bool o, bool n) { return n && !o; },
+      [&p](interval const & x) { p.added.push_back(x); });
+    merge_disjoint_interval_sets(std::begin(old_set), std::end(old_set),
+      std::begin(new_set), std::end(new_set),
+      [](bool o, bool n) { return o && !n; },
+      [&p](interval const & x) { p.removed.push_back(x); });
+    return p;
+  }
+
+  /**
+   * @brief Applies a patch to a disjoint set of intervals in one merge pass
+   *        over the set and both halves of the patch.
+   *
+   * The result is (s - removed) + added. Applied to the version the patch
+   * was computed from, it gives exactly the newer version.
+   *
+   * @param s A disjoint set of intervals.
+   * @param p The patch to apply.
+   * @return The patched set, which is another disjoint set of intervals.
+   */
+  template <typename Set, typename I>
+  Set apply_patch_disjoint_interval_set(Set const & s, interval_patch<I> const & p) {
+    Set out(s.get_allocator());
+    detail::boolean_sweep(
+      [](bool in, bool add, bool remove) { return add || (in && !remove); },
+      [&out](I const & x) { out.push_back(x); },
+      std::make_pair(s.begin(), s.end()),
+      std::make_pair(p.added.begin(), p.added.end()),
+      std::make_pair(p.removed.begin(), p.removed.end()));
+    return out;
+  }
+
+  /**
+   * @brief Applies a patch to a disjoint interval set.
+   */
+  template <typename I, typename A>
+  auto apply_patch(disjoint_interval_set<I, A> x, interval_patch<I> const & p) {
+    x.s_ = apply_patch_disjoint_interval_set(x.s_, p);
+    return x;
+  }
+
+  /**
+   * The binary form of a patch: a header, then the added and the removed
+   * intervals as records of the interval file format. The header carries a
+   * CRC-32 of the records and of itself.
+   */
+  struct interval_patch_header {
+    char magic[8];
+    std::uint32_t byte_order;
+    std::uint32_t version;
+    std::uint32_t value_size;
+    std::uint32_t value_kind;
+    std::uint64_t added;
+    std::uint64_t removed;
+    std::uint32_t records_crc;
+    std::uint32_t header_crc; // of all the fields before it
+  };
+
+  static_assert(sizeof(interval_patch_header) == 48, "the header is 48 bytes on the wire");
+
+  inline constexpr char interval_patch_magic[8] = {'D', 'I', 'S', 'E', 'T', 'P', 'A', 'T'};
+
+  /**
+   * @brief Encodes a patch in its binary form.
+   */
+  template <typename I>
+  std::vector<char> serialize_patch(interval_patch<I> const & p) {
+    using T = typename I::value_type;
+    auto const rs = detail::record_size<T>();
+    std::vector<char> out(sizeof(interval_patch_header) +
+                          (p.added.size() + p.removed.size()) * rs);
+
+    auto * r = out.data() + sizeof(interval_patch_header);
+    for (auto const & x : p.added) { detail::encode_record(r, x); r += rs; }
+    for (auto const & x : p.removed) { detail::encode_record(r, x); r += rs; }
+
+    interval_patch_header h{};
+    std::memcpy(h.magic, interval_patch_magic, sizeof h.magic);
+    h.byte_order = interval_file_byte_order;
+    h.version = interval_file_version;
+    h.value_size = sizeof(T);
+    h.value_kind = detail::value_kind<T>();
+    h.added = p.added.size();
+    h.removed = p.removed.size();
+    h.records_crc = detail::crc32(out.data() + sizeof h, out.size() - sizeof h);
+    h.header_crc = detail::crc32(&h, offsetof(interval_patch_header, header_crc));
+    std::memcpy(out.data(), &h, sizeof h);
+    return out;
+  }
+
+  /**
+   * @brief Decodes a patch from its binary form, throwing
+   *        std::runtime_error if it is malformed or corrupt.
+   */
+  template <typename I>
+  interval_patch<I> deserialize_patch(char const * data, std::size_t n) {
+    using T = typename I::value_type;
+    auto fail = [](char const * why) {
+      throw std::runtime_error(std::string("interval patch: ") + why);
+    };
+
+    interval_patch_header h;
+    if (n < sizeof h) fail("truncated");
+    std::memcpy(&h, data, sizeof h);
+    if (std::memcmp(h.magic, interval_patch_magic, sizeof h.magic) != 0) fail("bad magic");
+    if (h.byte_order != interval_file_byte_order) fail("foreign byte order");
+    if (h.header_crc != detail::crc32(&h, offsetof(interval_patch_header, header_crc)))
+      fail("corrupt header");
+    if (h.version != interval_file_version) fail("unsupported version");
+    if (h.value_size != sizeof(T) || h.value_kind != detail::value_kind<T>())
+      fail("stored values do not match the value type");
+
+    auto const rs = detail::record_size<T>();
+    auto const records = n - sizeof h;
+    if (h.added > records / rs || h.removed > records / rs - h.added ||
+        (h.added + h.removed) * rs != records)
+      fail("truncated");
+    if (detail::crc32(data + sizeof h, records) != h.records_crc) fail("corrupt records");
+
+    interval_patch<I> p;
+    p.added.reserve(h.added);
+    p.removed.reserve(h.removed);
+    auto const * r = data + sizeof h;
+    for (std::uint64_t i = 0; i < h.added; ++i, r += rs)
+      p.added.push_back(detail::decode_record<I>(r));
+    for (std::uint64_t i = 0; i < h.removed; ++i, r += rs)
+      p.removed.push_back(detail::decode_record<I>(r));
+    return p;
+  }
+}
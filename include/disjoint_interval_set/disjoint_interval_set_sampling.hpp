@@ -0,0 +1,143 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <type_traits>
+#include <vector>
+#include "disjoint_interval_set.hpp"
+
+namespace disjoint_interval_set {
+  /**
+   * Draws points uniformly from the region covered by a disjoint interval
+   * set. Over a floating-point domain the weight of an interval is its
+   * length; over an integral domain it is the number of integers it holds,
+   * counted in 64 bits so that the whole of a 32-bit type fits. An open
+   * endpoint is never drawn.
+   *
+   * Construction builds a prefix index of these weights once. A single draw
+   * then costs one variate and a binary search over the index, O(log n).
+   * A batch of m draws sorts its variates and resolves them all in one
+   * merge pass over the index, O(m log m + n), which touches memory
+   * sequentially instead of doing m independent searches.
+   *
+   * The set must have finite measure. A batch drawn from a set of measure
+   * zero is empty; a single draw from one is undefined.
+   */
+  template <typename I>
+  class interval_sampler {
+  public:
+    using interval_type = I;
+    using value_type = typename I::value_type;
+    // the weights are counts over integers, lengths otherwise
+    using weight_type = std::conditional_t<std::is_integral_v<value_type>,
+                                           std::uint64_t, value_type>;
+
+    template <typename Set>
+    explicit interval_sampler(Set const & s) {
+      weight_type total = 0;
+      for (auto const & i : s) {
+        auto const w = weight(i);
+        if (w == weight_type(0)) continue;
+        s_.push_back(i);
+        prefix_.push_back(total);
+        total += w;
+      }
+      total_ = total;
+    }
+
+    /**
+     * @brief The measure of the covered region.
+     */
+    weight_type measure() const { return total_; }
+
+    /**
+     * @brief Draws a single point, O(log n).
+     */
+    template <typename URBG>
+    value_type operator()(URBG & rng) const {
+      auto const u = variate(rng);
+      auto const k = static_cast<std::size_t>(
+        std::upper_bound(prefix_.begin(), prefix_.end(), u) - prefix_.begin() - 1);
+      return point(k, u);
+    }
+
+    /**
+     * @brief Draws count points in one batch, returned in ascending order.
+     */
+    template <typename URBG>
+    std::vector<value_type> operator()(URBG & rng, std::size_t count) const {
+      if (s_.empty())
+        return {};
+
+      std::vector<weight_type> u(count);
+      for (auto & x : u)
+        x = variate(rng);
+      std::sort(u.begin(), u.end());
+
+      std::vector<value_type> out;
+      out.reserve(count);
+      std::size_t k = 0;
+      for (auto const x : u) {
+        while (k + 1 < prefix_.size() && prefix_[k + 1] <= x)
+          ++k;
+        out.push_back(point(k, x));
+      }
+      return out;
+    }
+
+  private:
+    std::vector<I> s_;
+    std::vector<weight_type> prefix_;
+    weight_type total_ = 0;
+
+    static weight_type weight(I const & i) {
+      if constexpr (std::is_integral_v<value_type>) {
+        auto const lo = i.left_open ? i.left + 1 : i.left;
+        auto const hi = i.right_open ? i.right - 1 : i.right;
+        // in weight_type, so that a span across all of value_type does not overflow
+        return hi < lo ? 0 : static_cast<weight_type>(hi) - static_cast<weight_type>(lo) + 1;
+      } else {
+        // an open interval with no representable value inside has nothing to draw
+        if (i.left_open && i.right_open && !(std::nextafter(i.left, i.right) < i.right))
+          return 0;
+        return i.right - i.left;
+      }
+    }
+
+    // a uniform variate over [0, measure())
+    template <typename URBG>
+    weight_type variate(URBG & rng) const {
+      if constexpr (std::is_integral_v<value_type>)
+        return std::uniform_int_distribution<weight_type>(0, total_ - 1)(rng);
+      else
+        return std::uniform_real_distribution<weight_type>(0, total_)(rng);
+    }
+
+    // the point at offset u - prefix_[k] into interval k; an open endpoint
+    // is never returned, rounding lands on its neighbour inside instead
+    value_type point(std::size_t k, weight_type u) const {
+      auto const & i = s_[k];
+      if constexpr (std::is_integral_v<value_type>) {
+        using unsigned_type = std::make_unsigned_t<value_type>;
+        auto const lo = static_cast<unsigned_type>(i.left_open ? i.left + 1 : i.left);
+        return static_cast<value_type>(lo + static_cast<unsigned_type>(u - prefix_[k]));
+      } else {
+        auto p = std::min(i.left + (u - prefix_[k]), i.right);
+        if (i.left_open && p <= i.left) p = std::nextafter(i.left, i.right);
+        if (i.right_open && p >= i.right) p = std::nextafter(i.right, i.left);
+        return p;
+      }
+    }
+  };
+
+  /**
+   * @brief Draws count points uniformly from the region covered by s, in
+   *        ascending order.
+   */
+  template <typename I, typename A, typename URBG>
+  auto sample(disjoint_interval_set<I, A> const & s, URBG & rng, std::size_t count) {
+    return interval_sampler<I>(s)(rng, count);
+  }
+}
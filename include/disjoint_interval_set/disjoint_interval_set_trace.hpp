@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+
+namespace disjoint_interval_set {
+  /**
+   * @brief The internal phases of the algorithms that report trace events.
+   */
+  enum class trace_phase {
+    sort,       // sorting intervals by their left endpoints
+    coalesce,   // the merge loop that fuses overlapping intervals
+    complement, // the sweep that computes a complement
+    allocate,   // copying intervals into a set, growing its storage
+    parse,      // parsing a string-encoded set of intervals
+    merge       // merging sorted runs spilled to disk
+  };
+
+  /**
+   * @brief Whether a trace event opens or closes a phase.
+   */
+  enum class trace_event { begin, end };
+
+  /**
+   * @brief A trace hook receives the phase, whether it begins or ends, and a
+   *        size. On begin the size is the input size (intervals or bytes), on
+   *        end it is the output size.
+   */
+  using trace_hook = void (*)(trace_phase, trace_event, std::size_t);
+
+#ifdef DISJOINT_INTERVAL_SET_TRACE
+  /**
+   * @brief The installed hook, or nullptr if tracing is switched off at
+   *        run-time.
+   */
+  inline trace_hook & current_trace_hook() {
+    static trace_hook hook = nullptr;
+    return hook;
+  }
+
+  /**
+   * @brief Installs a trace hook and returns the previously installed one.
+   *
+   * @param hook The new hook, or nullptr to stop tracing.
+   * @return The hook that was installed before.
+   */
+  inline trace_hook set_trace_hook(trace_hook hook) {
+    auto old = current_trace_hook();
+    current_trace_hook() = hook;
+    return old;
+  }
+
+  /**
+   * @brief Emits a begin event on construction and an end event on
+   *        destruction, so a phase is closed on every exit path.
+   */
+  class trace_scope {
+  public:
+    trace_scope(trace_phase phase, std::size_t n) :
+      hook_(current_trace_hook()), phase_(phase), n_(n) {
+      if (hook_) hook_(phase_, trace_event::begin, n_);
+    }
+
+    trace_scope(trace_scope const &) = delete;
+    trace_scope & operator=(trace_scope const &) = delete;
+
+    ~trace_scope() { if (hook_) hook_(phase_, trace_event::end, n_); }
+
+    /**
+     * @brief Sets the size reported by the end event.
+     */
+    void output(std::size_t n) { n_ = n; }
+
+  private:
+    trace_hook hook_;
+    trace_phase phase_;
+    std::size_t n_;
+  };
+#else
+  /**
+   * Without DISJOINT_INTERVAL_SET_TRACE the hooks compile to nothing.
+   */
+  inline trace_hook set_trace_hook(trace_hook) { return nullptr; }
+
+  class trace_scope {
+  public:
+    trace_scope(trace_phase, std::size_t) {}
+    void output(std::size_t) {}
+  };
+#endif
+}
@@ -0,0 +1,235 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "disjoint_interval_set.hpp"
+#include "disjoint_interval_set_file.hpp"
+#include "disjoint_interval_set_trace.hpp"
+#include "paged_interval_set.hpp"
+
+namespace disjoint_interval_set {
+  /**
+   * Builds a disjoint interval set from more intervals than fit in memory,
+   * by external merge sort.
+   *
+   * Intervals are buffered up to a memory budget. A full buffer is sorted
+   * and written out as a run in the interval file format, coalesced as it
+   * is written, so overlapping input shrinks before it reaches the disk.
+   * finish() then merges all runs through a heap of cursors into a single
+   * canonical set, reading each run sequentially one page at a time. When
+   * there are more runs than the budget has pages for, groups of them are
+   * first merged into longer runs.
+   *
+   * Runs go to a private directory under temp_dir that is removed with the
+   * builder.
+   */
+  template <typename I>
+  class external_builder {
+  public:
+    using interval_type = I;
+    using value_type = typename I::value_type;
+
+    /**
+     * @param temp_dir Where to write the runs.
+     * @param memory_bytes The memory budget for buffering and merging.
+     * @param run_page_bytes The page size of the runs; larger pages mean
+     *                       longer sequential reads and a smaller fan-in.
+     */
+    explicit external_builder(std::string const & temp_dir,
+                              std::size_t memory_bytes = std::size_t(256) << 20,
+                              std::size_t run_page_bytes = std::size_t(256) << 10) :
+      run_page_bytes_(run_page_bytes),
+      capacity_(std::max<std::size_t>(memory_bytes / sizeof(I), 1)),
+      fan_in_(std::clamp<std::size_t>(memory_bytes / run_page_bytes, 2, 256)) {
+      std::string pattern = temp_dir + "/disjoint-interval-set-XXXXXX";
+      if (!::mkdtemp(pattern.data())) detail::throw_errno("mkdtemp " + pattern);
+      dir_ = pattern;
+    }
+
+    external_builder(external_builder const &) = delete;
+    external_builder & operator=(external_builder const &) = delete;
+
+    ~external_builder() {
+      for (auto const & r : runs_) ::unlink(r.c_str());
+      ::rmdir(dir_.c_str());
+    }
+
+    void push(I const & x) {
+      if (detail::vacuous(x)) return;
+      // grow geometrically, but never past the budget, so small inputs do
+      // not claim all of it
+      if (buf_.size() == buf_.capacity())
+        buf_.reserve(std::min(capacity_, std::max<std::size_t>(2 * buf_.capacity(), 1024)));
+      buf_.push_back(x);
+      if (buf_.size() == capacity_) spill();
+    }
+
+    template <typename It>
+    void push(It first, It last) {
+      for (; first != last; ++first) push(*first);
+    }
+
+    /**
+     * @brief The number of runs spilled so far.
+     */
+    std::size_t runs() const { return runs_.size(); }
+
+    /**
+     * @brief Merges everything pushed into a canonical set, calling
+     *        emit(interval) for each of its intervals in order.
+     */
+    template <typename Emit>
+    void finish(Emit emit) {
+      coalescer<Emit> out{emit};
+      if (runs_.empty()) {
+        // the input never left memory
+        sort_buffer();
+        for (auto const & x : buf_) out(x);
+      } else {
+        if (!buf_.empty()) spill();
+        release();
+        while (runs_.size() > fan_in_) {
+          std::vector<std::string> group(runs_.begin(), runs_.begin() + fan_in_);
+          interval_file_writer<I> w(next_run(), run_page_bytes_);
+          // the merged run is listed before it is written, and the group is
+          // dropped only once it is complete, so that a failure leaves
+          // every file to the destructor
+          runs_.push_back(w.path());
+          merge(group, [&w](I const & x) { w.push(x); });
+          w.finish();
+          runs_.erase(runs_.begin(), runs_.begin() + fan_in_);
+          for (auto const & r : group) ::unlink(r.c_str());
+        }
+        merge(runs_, [&out](I const & x) { out(x); });
+      }
+      out.flush();
+      release();
+    }
+
+    /**
+     * @brief Merges everything pushed into a file, in the page size of out.
+     *
+     * @return The number of intervals written.
+     */
+    std::uint64_t finish(interval_file_writer<I> & out, bool sync = false) {
+      finish([&out](I const & x) { out.push(x); });
+      return out.finish(sync);
+    }
+
+    /**
+     * @brief Merges everything pushed into a set in memory from a.
+     */
+    template <typename A = std::allocator<I>>
+    disjoint_interval_set<I, A> to_set(A const & a = A()) {
+      std::vector<I> v;
+      finish([&v](I const & x) { v.push_back(x); });
+      return disjoint_interval_set<I, A>(v.begin(), v.end(), a);
+    }
+
+  private:
+    std::string dir_;
+    std::size_t run_page_bytes_;
+    std::size_t capacity_;
+    std::size_t fan_in_;
+    std::vector<I> buf_;
+    std::vector<std::string> runs_;
+    std::size_t next_ = 0;
+
+    // fuses each interval with the last while they overlap or touch
+    template <typename Emit>
+    struct coalescer {
+      Emit & emit;
+      I tail{};
+      bool has = false;
+
+      void operator()(I const & x) {
+        if (has && detail::mergeable(tail, x)) {
+          tail = detail::hull(tail, x);
+          return;
+        }
+        if (has) emit(tail);
+        tail = x;
+        has = true;
+      }
+
+      void flush() {
+        if (has) emit(tail);
+        has = false;
+      }
+    };
+
+    std::string next_run() {
+      return dir_ + "/run-" + std::to_string(next_++);
+    }
+
+    void sort_buffer() {
+      trace_scope trace(trace_phase::sort, buf_.size());
+      std::sort(buf_.begin(), buf_.end(), std::less<I>{});
+    }
+
+    void release() {
+      std::vector<I>().swap(buf_);
+    }
+
+    void spill() {
+      sort_buffer();
+      interval_file_writer<I> w(next_run(), run_page_bytes_);
+      w.push(buf_.begin(), buf_.end());
+      w.finish();
+      runs_.push_back(w.path());
+      buf_.clear();
+    }
+
+    // k-way merge of runs by left endpoint; the output may still overlap
+    template <typename Emit>
+    void merge(std::vector<std::string> const & paths, Emit emit) {
+      using iterator = typename paged_interval_set<I>::const_iterator;
+      struct cursor { iterator i, e; };
+
+      std::vector<std::unique_ptr<paged_interval_set<I>>> sets;
+      std::vector<cursor> cs;
+      for (auto const & p : paths) {
+        sets.push_back(std::make_unique<paged_interval_set<I>>(p, 1));
+        if (!sets.back()->empty())
+          cs.push_back(cursor{sets.back()->begin(), sets.back()->end()});
+      }
+
+      trace_scope trace(trace_phase::merge, cs.size());
+      auto later = [&cs](std::size_t a, std::size_t b) {
+        return std::less<I>{}(*cs[b].i, *cs[a].i);
+      };
+      std::priority_queue<std::size_t, std::vector<std::size_t>, decltype(later)> heap(later);
+      for (std::size_t c = 0; c < cs.size(); ++c) heap.push(c);
+
+      while (!heap.empty()) {
+        auto const c = heap.top();
+        heap.pop();
+        emit(*cs[c].i);
+        if (++cs[c].i != cs[c].e) heap.push(c);
+      }
+    }
+  };
+
+  /**
+   * @brief Builds the canonical set of a range of intervals too large for
+   *        memory and writes it to a file.
+   *
+   * @return The number of intervals written.
+   */
+  template <typename It, typename I = std::decay_t<decltype(*std::declval<It>())>>
+  std::uint64_t make_disjoint_interval_set_external(It first, It last,
+                                                    interval_file_writer<I> & out,
+                                                    std::string const & temp_dir,
+                                                    std::size_t memory_bytes = std::size_t(256) << 20) {
+    external_builder<I> b(temp_dir, memory_bytes);
+    b.push(first, last);
+    return b.finish(out);
+  }
+}
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "disjoint_interval_set.hpp"
+#include "disjoint_interval_set_memory.hpp"
+#include "interval.hpp"
+
+namespace disjoint_interval_set {
+  /**
+   * An index over a collection of possibly overlapping intervals, each
+   * carrying a payload, for stabbing and overlap queries. Unlike a
+   * disjoint_interval_set it keeps every interval and its identity; to_set()
+   * coalesces them into one.
+   *
+   * The intervals are sorted by left endpoint and the sorted array itself
+   * is an implicit balanced binary search tree: the nodes at level k are
+   * the indices whose lowest k bits are set, with the root at 2^K - 1.
+   * Each node is augmented with the greatest right endpoint in its subtree,
+   * which prunes subtrees that end before a query. There are no pointers,
+   * and queries walk a contiguous array, visiting O(log n + k) nodes for k
+   * matches; small subtrees are scanned linearly.
+   *
+   * Intervals are added with insert() and become queryable after build();
+   * querying an index with intervals inserted since is a precondition
+   * violation, checked by assert.
+   */
+  template <typename I, typename Payload = std::size_t>
+  class interval_index {
+  public:
+    using interval_type = I;
+    using value_type = typename I::value_type;
+    using payload_type = Payload;
+
+    struct entry {
+      I interval;
+      Payload payload;
+      value_type max_right; // the greatest right endpoint in the subtree
+    };
+
+    /**
+     * @brief Adds an interval; the index must be rebuilt before querying.
+     */
+    void insert(I const & x, Payload p) {
+      if (detail::vacuous(x)) return;
+      a_.push_back(entry{x, std::move(p), x.right});
+      built_ = false;
+    }
+
+    /**
+     * @brief Sorts the intervals and computes the subtree maxima, O(n log n).
+     */
+    void build() {
+      std::sort(a_.begin(), a_.end(), [](entry const & l, entry const & r) {
+        return std::less<I>{}(l.interval, r.interval);
+      });
+      levels_ = augment();
+      built_ = true;
+    }
+
+    bool built() const { return built_; }
+    auto size() const { return a_.size(); }
+    auto empty() const { return a_.empty(); }
+    auto begin() const { return a_.begin(); }
+    auto end() const { return a_.end(); }
+
+    /**
+     * @brief Calls f(entry) for every interval that intersects q; the index
+     *        must be built.
+     */
+    template <typename F>
+    void overlap(I const & q, F f) const {
+      assert(built_ && "interval_index queried before build()");
+      if (a_.empty() || detail::vacuous(q)) return;
+
+      struct cell { int k; std::size_t x; bool left_done; };
+      cell stack[64];
+      int t = 0;
+      auto const n = a_.size();
+      stack[t++] = cell{levels_, (std::size_t(1) << levels_) - 1, false};
+
+      while (t != 0) {
+        auto const z = stack[--t];
+        if (z.k <= 3) {
+          // a small subtree: scan it in order until intervals start past q
+          auto const i0 = z.x >> z.k << z.k;
+          auto const i1 = std::min(i0 + (std::size_t(1) << (z.k + 1)) - 1, n);
+          for (auto i = i0; i < i1 && !starts_after(a_[i].interval, q); ++i)
+            if (intersects(a_[i].interval, q)) f(a_[i]);
+        } else if (!z.left_done) {
+          // revisit z after its left child, which is pushed only if it may
+          // reach q; a child out of range may still have descendants in range
+          auto const y = z.x - (std::size_t(1) << (z.k - 1));
+          stack[t++] = cell{z.k, z.x, true};
+          if (y >= n || !(a_[y].max_right < q.left))
+            stack[t++] = cell{z.k - 1, y, false};
+        } else if (z.x < n && !starts_after(a_[z.x].interval, q)) {
+          if (intersects(a_[z.x].interval, q)) f(a_[z.x]);
+          stack[t++] = cell{z.k - 1, z.x + (std::size_t(1) << (z.k - 1)), false};
+        }
+      }
+    }
+
+    /**
+     * @brief Calls f(entry) for every interval that contains v.
+     */
+    template <typename F>
+    void stab(value_type v, F f) const {
+      overlap(I(v, v), std::move(f));
+    }
+
+    /**
+     * @brief The payloads of the intervals that intersect q.
+     */
+    std::vector<Payload> overlapping(I const & q) const {
+      std::vector<Payload> out;
+      overlap(q, [&out](entry const & e) { out.push_back(e.payload); });
+      return out;
+    }
+
+    /**
+     * @brief The union of all the intervals, as a disjoint_interval_set in
+     *        memory from a.
+     */
+    template <typename A = std::allocator<I>>
+    disjoint_interval_set<I, A> to_set(A const & a = A()) const {
+      std::vector<I> v;
+      v.reserve(a_.size());
+      for (auto const & e : a_) v.push_back(e.interval);
+      return disjoint_interval_set<I, A>(v.begin(), v.end(), a);
+    }
+
+    memory_footprint memory_usage() const {
+      memory_footprint m;
+      m.intervals = a_.size();
+      m.heap_bytes = a_.capacity() * sizeof(entry);
+      m.slack_bytes = (a_.capacity() - a_.size()) * sizeof(entry);
+      m.padding_bytes = a_.size() * interval_padding<I>();
+      return m;
+    }
+
+  private:
+    std::vector<entry> a_;
+    int levels_ = 0;
+    bool built_ = true;
+
+    static bool starts_after(I const & x, I const & q) {
+      return x.left > q.right;
+    }
+
+    static bool intersects(I const & x, I const & q) {
+      return !detail::vacuous(x * q);
+    }
+
+    // computes max_right bottom-up, level by level; returns the root level
+    int augment() {
+      auto const n = a_.size();
+      if (n == 0) return 0;
+
+      // leaves are the even indices; last tracks the maximum of the
+      // rightmost, possibly incomplete, subtree at each level
+      std::size_t last_i = 0;
+      value_type last = a_[0].interval.right;
+      for (std::size_t i = 0; i < n; i += 2) {
+        last_i = i;
+        last = a_[i].max_right = a_[i].interval.right;
+      }
+
+      int k = 1;
+      for (; (std::size_t(1) << k) <= n; ++k) {
+        auto const x = std::size_t(1) << (k - 1);
+        auto const i0 = (x << 1) - 1, step = x << 2;
+        for (auto i = i0; i < n; i += step) {
+          auto const el = a_[i - x].max_right;
+          auto const er = i + x < n ? a_[i + x].max_right : last;
+          a_[i].max_right = std::max({a_[i].interval.right, el, er});
+        }
+        last_i = (last_i >> k & 1) ? last_i - x : last_i + x;
+        if (last_i < n && a_[last_i].max_right > last)
+          last = a_[last_i].max_right;
+      }
+      return k - 1;
+    }
+  };
+}
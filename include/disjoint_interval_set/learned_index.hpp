@@ -0,0 +1,205 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <vector>
+#include "disjoint_interval_set_memory.hpp"
+#include "interval.hpp"
+
+namespace disjoint_interval_set {
+  /**
+   * A learned index over the left endpoints of an immutable disjoint
+   * interval set, in the style of the PGM-index.
+   *
+   * The map from a left endpoint to its position is approximated by a
+   * piecewise linear function in which every segment predicts the position
+   * of each of its keys to within epsilon. The first keys of the segments
+   * are indexed the same way, level by level, until a single segment is
+   * left. A lookup evaluates one segment per level and searches a window
+   * of about 2 epsilon + 2 entries around each prediction, instead of
+   * binary searching the whole set. Endpoints that grow nearly linearly
+   * need very few segments, so the index is a small fraction of the set.
+   *
+   * Segments are fitted greedily with a shrinking cone of feasible slopes.
+   * Should rounding ever move a key outside its window, the search falls
+   * back to a binary search, so lookups are always exact.
+   *
+   * The index does not own the intervals: it views a contiguous range that
+   * must outlive it and stay unchanged.
+   */
+  template <typename I>
+  class learned_index {
+  public:
+    using interval_type = I;
+    using value_type = typename I::value_type;
+    using const_iterator = I const *;
+
+    /**
+     * @brief Builds the index over a contiguous, canonical set, O(n).
+     *
+     * @param epsilon The greatest prediction error over the intervals;
+     *                larger values give fewer segments and wider searches.
+     */
+    template <typename Set>
+    explicit learned_index(Set const & s, std::size_t epsilon = 64) :
+      a_(std::to_address(std::begin(s))),
+      n_(static_cast<std::size_t>(std::distance(std::begin(s), std::end(s)))),
+      eps_(std::max<std::size_t>(epsilon, 1)) {
+      if (n_ == 0) return;
+
+      std::vector<double> keys(n_);
+      for (std::size_t i = 0; i < n_; ++i)
+        keys[i] = static_cast<double>(a_[i].left);
+      // an infinite key would make the model predict NaN; infinite keys
+      // take the value of the nearest finite one, which keeps them in order
+      auto const finite = [](double k) { return std::isfinite(k); };
+      auto const first = std::find_if(keys.begin(), keys.end(), finite);
+      if (first != keys.end()) {
+        lo_key_ = *first;
+        hi_key_ = *std::find_if(keys.rbegin(), keys.rend(), finite);
+      }
+      for (auto & k : keys) k = std::clamp(k, lo_key_, hi_key_);
+      levels_.push_back(fit(keys, eps_));
+      while (levels_.back().size() > 1) {
+        auto const & below = levels_.back();
+        keys.resize(below.size());
+        for (std::size_t i = 0; i < below.size(); ++i) keys[i] = below[i].key;
+        levels_.push_back(fit(keys, internal_eps));
+      }
+    }
+
+    /**
+     * @brief The number of intervals whose left endpoint is no greater
+     *        than v.
+     */
+    std::size_t rank(value_type v) const {
+      if (n_ == 0) return 0;
+      auto const x = std::clamp(static_cast<double>(v), lo_key_, hi_key_);
+
+      // descend to the level-0 segment covering v
+      std::size_t s = 0;
+      for (auto l = levels_.size() - 1; l > 0; --l) {
+        auto const & below = levels_[l - 1];
+        auto const & seg = levels_[l][s];
+        auto const k = search(below.size(), predict(seg, x, below.size()), internal_eps,
+                              [&](std::size_t i) { return x < below[i].key; });
+        s = k == 0 ? 0 : k - 1;
+      }
+      auto const & seg = levels_[0][s];
+      return search(n_, predict(seg, x, n_), eps_,
+                    [&](std::size_t i) { return v < a_[i].left; });
+    }
+
+    /**
+     * @brief The interval containing v, or end().
+     */
+    const_iterator locate(value_type v) const {
+      auto const k = rank(v);
+      return (k != 0 && a_[k - 1].contains(v)) ? a_ + (k - 1) : end();
+    }
+
+    bool contains(value_type v) const { return locate(v) != end(); }
+
+    const_iterator begin() const { return a_; }
+    const_iterator end() const { return a_ + n_; }
+    std::size_t size() const { return n_; }
+
+    /**
+     * @brief The number of segments at each level, from the bottom up.
+     */
+    std::vector<std::size_t> segments() const {
+      std::vector<std::size_t> out;
+      for (auto const & l : levels_) out.push_back(l.size());
+      return out;
+    }
+
+    /**
+     * @brief The footprint of the index alone; the intervals are not
+     *        counted since the index does not own them.
+     */
+    memory_footprint memory_usage() const {
+      memory_footprint m;
+      m.intervals = n_;
+      for (auto const & l : levels_) {
+        m.heap_bytes += l.capacity() * sizeof(segment);
+        m.slack_bytes += (l.capacity() - l.size()) * sizeof(segment);
+      }
+      m.heap_bytes += levels_.capacity() * sizeof(std::vector<segment>);
+      return m;
+    }
+
+  private:
+    struct segment {
+      double key;       // the first key in the segment
+      double slope;
+      double intercept; // the position of the first key
+    };
+
+    static constexpr std::size_t internal_eps = 4;
+
+    I const * a_;
+    std::size_t n_;
+    std::size_t eps_;
+    std::vector<std::vector<segment>> levels_;
+    // the least and the greatest finite key, to which the others are clamped
+    double lo_key_ = 0, hi_key_ = 0;
+
+    // greedy shrinking-cone fit: a segment grows while some slope keeps
+    // every key within eps of its position
+    static std::vector<segment> fit(std::vector<double> const & keys, std::size_t eps) {
+      std::vector<segment> out;
+      auto const e = static_cast<double>(eps);
+      std::size_t i = 0;
+      while (i < keys.size()) {
+        auto const x0 = keys[i];
+        auto const y0 = static_cast<double>(i);
+        double lo = 0, hi = std::numeric_limits<double>::infinity();
+        auto j = i + 1;
+        for (; j < keys.size(); ++j) {
+          auto const dx = keys[j] - x0;
+          auto const dy = static_cast<double>(j) - y0;
+          if (!(dx > 0)) {
+            if (dy > e) break;
+            continue;
+          }
+          if (dy > hi * dx + e || dy < lo * dx - e) break;
+          hi = std::min(hi, (dy + e) / dx);
+          lo = std::max(lo, (dy - e) / dx);
+        }
+        auto const slope = hi == std::numeric_limits<double>::infinity() ? lo : (lo + hi) / 2;
+        out.push_back(segment{x0, slope, y0});
+        i = j;
+      }
+      return out;
+    }
+
+    static std::size_t predict(segment const & s, double x, std::size_t n) {
+      auto const p = s.intercept + s.slope * (x - s.key);
+      if (!(p > 0)) return 0;
+      if (!(p < static_cast<double>(n))) return n;
+      return static_cast<std::size_t>(p);
+    }
+
+    // the first i in [0, n) with greater(i), searched in a window of eps
+    // around pos and widened to everything if the window misses
+    template <typename Greater>
+    static std::size_t search(std::size_t n, std::size_t pos, std::size_t eps, Greater greater) {
+      auto lo = pos > eps + 1 ? pos - eps - 1 : 0;
+      auto hi = std::min(n, pos + eps + 2);
+      if ((lo != 0 && greater(lo - 1)) || (hi != n && !greater(hi))) {
+        lo = 0;
+        hi = n;
+      }
+      while (lo < hi) {
+        auto const mid = lo + (hi - lo) / 2;
+        if (greater(mid)) hi = mid;
+        else lo = mid + 1;
+      }
+      return lo;
+    }
+  };
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <numeric>
+#include <thread>
+#include <vector>
+#include "disjoint_interval_set_algorithms.hpp"
+#include "interval.hpp"
+
+namespace disjoint_interval_set {
+  namespace detail {
+    /**
+     * Sort-merge sweep over two index lists sorted by left endpoint. Every
+     * interval stays in an active list until the sweep passes its right
+     * endpoint; a new interval is tested against the other side's active
+     * list, pruning expired entries as it goes.
+     *
+     * All active intervals start no later than the new one, so an overlap
+     * starts at the new interval's left endpoint. A pair is reported only
+     * if that point lies in [lo, hi), which lets partitions of the domain
+     * run independently without reporting a pair twice.
+     */
+    template <typename LIt, typename RIt, typename T, typename Emit>
+    void sweep_join(LIt left, std::vector<std::size_t> const & li,
+                    RIt right, std::vector<std::size_t> const & ri,
+                    T lo, T hi, bool bounded_below, bool bounded_above,
+                    Emit & emit) {
+      std::vector<std::size_t> active_left, active_right;
+      std::size_t a = 0, b = 0;
+
+      auto scan = [](auto const & x, auto other, std::vector<std::size_t> & active,
+                     bool report, auto && hit) {
+        for (std::size_t k = 0; k < active.size(); ) {
+          auto const & y = other[active[k]];
+          if (y.right < x.left) {
+            active[k] = active.back();
+            active.pop_back();
+            continue;
+          }
+          if (report && !vacuous(x * y)) hit(active[k]);
+          ++k;
+        }
+      };
+
+      while (a < li.size() || b < ri.size()) {
+        bool const from_left = b == ri.size() ||
+          (a < li.size() && !(right[ri[b]].left < left[li[a]].left));
+        auto const & x = from_left ? left[li[a]] : right[ri[b]];
+        if (bounded_above && !(x.left < hi))
+          break;
+        bool const report = !bounded_below || !(x.left < lo);
+
+        if (from_left) {
+          auto const i = li[a++];
+          scan(x, right, active_right, report, [&](std::size_t j) { emit(i, j); });
+          active_left.push_back(i);
+        } else {
+          auto const j = ri[b++];
+          scan(x, left, active_left, report, [&](std::size_t i) { emit(i, j); });
+          active_right.push_back(j);
+        }
+      }
+    }
+  }
+
+  /**
+   * @brief Reports every overlapping pair between two collections of
+   *        possibly overlapping intervals.
+   *
+   * Both collections are sorted by left endpoint and joined with an
+   * active-set sweep, in O((n + m) log(n + m) + k) for k pairs when
+   * intervals are short. Two intervals overlap if their intersection,
+   * x * y, is not empty.
+   *
+   * With more than one thread, the domain is cut at quantiles of the left
+   * endpoints into one partition per thread. Each interval joins every
+   * partition it reaches, and each partition reports the pairs whose
+   * intersection starts inside it, so every pair is reported exactly once.
+   *
+   * @param left A random-access range of intervals.
+   * @param right A random-access range of intervals.
+   * @param emit Called as emit(i, j) for every overlapping pair of the i-th
+   *             left and the j-th right interval, concurrently from several
+   *             threads when threads > 1.
+   * @param threads The number of worker threads.
+   */
+  template <typename LeftRange, typename RightRange, typename Emit>
+  void overlap_join(LeftRange const & left, RightRange const & right, Emit emit,
+                    unsigned threads = std::thread::hardware_concurrency()) {
+    auto const l = std::begin(left);
+    auto const r = std::begin(right);
+    using interval = std::decay_t<decltype(*l)>;
+    using value_type = typename interval::value_type;
+
+    auto sorted = [](auto first, std::size_t n) {
+      std::vector<std::size_t> ix(n);
+      std::iota(ix.begin(), ix.end(), std::size_t(0));
+      std::sort(ix.begin(), ix.end(), [first](std::size_t a, std::size_t b) {
+        return first[a].left < first[b].left;
+      });
+      return ix;
+    };
+    auto const li = sorted(l, static_cast<std::size_t>(std::distance(l, std::end(left))));
+    auto const ri = sorted(r, static_cast<std::size_t>(std::distance(r, std::end(right))));
+
+    auto const n = li.size() + ri.size();
+    if (threads <= 1 || n < 2 * std::size_t(threads)) {
+      detail::sweep_join(l, li, r, ri, value_type{}, value_type{}, false, false, emit);
+      return;
+    }
+
+    // partition boundaries at quantiles of all left endpoints
+    std::vector<value_type> lefts;
+    lefts.reserve(n);
+    for (auto i : li) lefts.push_back(l[i].left);
+    for (auto j : ri) lefts.push_back(r[j].left);
+    std::vector<value_type> cuts;
+    for (unsigned p = 1; p < threads; ++p) {
+      auto const q = lefts.begin() + static_cast<std::ptrdiff_t>(n * p / threads);
+      std::nth_element(lefts.begin(), q, lefts.end());
+      if (cuts.empty() || cuts.back() < *q) cuts.push_back(*q);
+    }
+    auto const parts = cuts.size() + 1;
+
+    // the intervals each partition [cuts[p - 1], cuts[p]) reaches, still sorted
+    auto assign = [&](auto first, std::vector<std::size_t> const & ix) {
+      std::vector<std::vector<std::size_t>> out(parts);
+      for (auto i : ix) {
+        auto const & x = first[i];
+        auto const p0 = static_cast<std::size_t>(
+          std::upper_bound(cuts.begin(), cuts.end(), x.left) - cuts.begin());
+        auto const p1 = static_cast<std::size_t>(
+          std::upper_bound(cuts.begin(), cuts.end(), x.right) - cuts.begin());
+        for (auto p = p0; p <= p1; ++p) out[p].push_back(i);
+      }
+      return out;
+    };
+    auto const lp = assign(l, li);
+    auto const rp = assign(r, ri);
+
+    std::vector<std::thread> workers;
+    for (std::size_t p = 0; p < parts; ++p) {
+      workers.emplace_back([&, p] {
+        detail::sweep_join(l, lp[p], r, rp[p],
+                           p == 0 ? value_type{} : cuts[p - 1],
+                           p + 1 == parts ? value_type{} : cuts[p],
+                           p != 0, p + 1 != parts, emit);
+      });
+    }
+    for (auto & w : workers) w.join();
+  }
+}
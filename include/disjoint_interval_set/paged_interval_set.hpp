@@ -0,0 +1,258 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "disjoint_interval_set_algorithms.hpp"
+#include "disjoint_interval_set_file.hpp"
+#include "disjoint_interval_set_memory.hpp"
+#include "interval.hpp"
+
+namespace disjoint_interval_set {
+  /**
+   * A read-only disjoint interval set that stays on disk, in the interval
+   * file format, for sets far larger than memory.
+   *
+   * Only the fences, the first left endpoint of every page, are held in
+   * memory. A point or range query binary searches the fences for its
+   * first page and reads pages through a buffer cache that keeps the most
+   * recently used ones, so a lookup costs at most one read when the cache
+   * misses. Every page is checked against its checksum when read.
+   *
+   * Iteration walks the file front to back, one page at a time, bypassing
+   * the cache so that a full scan does not evict the pages queries keep
+   * hot. It feeds the streaming set operations below and every algorithm
+   * that takes a range of intervals.
+   *
+   * Queries update the cache, so a set must not be queried from several
+   * threads at once.
+   */
+  template <typename I>
+  class paged_interval_set {
+  public:
+    using interval_type = I;
+    using value_type = typename I::value_type;
+    using page_type = std::vector<I>;
+
+    struct cache_statistics {
+      std::uint64_t hits = 0;
+      std::uint64_t misses = 0;
+    };
+
+    /**
+     * Reads the file page by page in order; the page being read is shared
+     * with the iterator's copies.
+     */
+    class const_iterator {
+    public:
+      using iterator_category = std::input_iterator_tag;
+      using value_type = I;
+      using difference_type = std::ptrdiff_t;
+      using pointer = I const *;
+      using reference = I const &;
+
+      const_iterator() = default;
+
+      reference operator*() const { return (*page_)[i_]; }
+      pointer operator->() const { return &(*page_)[i_]; }
+
+      const_iterator & operator++() {
+        if (++i_ == page_->size()) {
+          i_ = 0;
+          page_ = ++k_ < s_->pages() ? s_->read_page(k_) : nullptr;
+        }
+        return *this;
+      }
+
+      const_iterator operator++(int) {
+        auto const old = *this;
+        ++*this;
+        return old;
+      }
+
+      // the end is one past the last page
+      bool operator==(const_iterator const & o) const {
+        return k_ == o.k_ && i_ == o.i_;
+      }
+      bool operator!=(const_iterator const & o) const { return !(*this == o); }
+
+    private:
+      friend class paged_interval_set;
+
+      paged_interval_set const * s_ = nullptr;
+      std::shared_ptr<page_type const> page_;
+      std::uint64_t k_ = 0;
+      std::size_t i_ = 0;
+
+      const_iterator(paged_interval_set const * s, std::uint64_t k) : s_(s), k_(k) {
+        if (k_ < s_->pages()) page_ = s_->read_page(k_);
+      }
+    };
+
+    /**
+     * @brief Opens a file written by an interval_file_writer.
+     *
+     * @param cache_pages The number of pages the buffer cache holds.
+     */
+    explicit paged_interval_set(std::string const & path, std::size_t cache_pages = 256) :
+      path_(path), fd_(path, O_RDONLY), capacity_(std::max<std::size_t>(cache_pages, 1)) {
+      fd_.read_at(&h_, sizeof h_, 0);
+      detail::check_header<value_type>(h_, path_);
+      fences_.resize(h_.pages);
+      fd_.read_at(fences_.data(), fences_.size() * sizeof(value_type), h_.fences_offset);
+      if (detail::crc32(fences_.data(), fences_.size() * sizeof(value_type)) != h_.fences_crc)
+        throw std::runtime_error(path_ + ": corrupt fences");
+    }
+
+    std::uint64_t size() const { return h_.intervals; }
+    bool empty() const { return h_.intervals == 0; }
+    std::uint64_t pages() const { return h_.pages; }
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, h_.pages); }
+
+    bool contains(value_type v) const {
+      auto const k = page_of(v);
+      if (k == h_.pages) return false;
+      auto const p = page(k);
+      return detail::sorted_contains(p->begin(), p->end(), v);
+    }
+
+    /**
+     * @brief Calls f(interval) for every interval that intersects q, in
+     *        order, reading only the pages q spans.
+     */
+    template <typename F>
+    void for_each(I const & q, F f) const {
+      if (detail::vacuous(q)) return;
+      auto k = page_of(q.left);
+      if (k == h_.pages) k = 0;
+      for (; k < h_.pages; ++k) {
+        auto const p = page(k);
+        for (auto const & x : *p) {
+          if (x.left > q.right) return;
+          if (!detail::vacuous(x * q)) f(x);
+        }
+      }
+    }
+
+    /**
+     * @brief The intervals that intersect q.
+     */
+    std::vector<I> intersecting(I const & q) const {
+      std::vector<I> out;
+      for_each(q, [&out](I const & x) { out.push_back(x); });
+      return out;
+    }
+
+    /**
+     * @brief Page k, from the buffer cache or read into it.
+     */
+    std::shared_ptr<page_type const> page(std::uint64_t k) const {
+      if (auto it = cache_.find(k); it != cache_.end()) {
+        ++stats_.hits;
+        lru_.splice(lru_.begin(), lru_, it->second.second);
+        return it->second.first;
+      }
+      ++stats_.misses;
+      auto p = read_page(k);
+      if (cache_.size() == capacity_) {
+        cache_.erase(lru_.back());
+        lru_.pop_back();
+      }
+      lru_.push_front(k);
+      cache_.emplace(k, std::make_pair(p, lru_.begin()));
+      return p;
+    }
+
+    cache_statistics statistics() const { return stats_; }
+
+    /**
+     * @brief The memory held: the fences and the cached pages.
+     */
+    memory_footprint memory_usage() const {
+      memory_footprint m;
+      m.heap_bytes = fences_.capacity() * sizeof(value_type);
+      for (auto const & [k, e] : cache_) {
+        m.intervals += e.first->size();
+        m.heap_bytes += e.first->capacity() * sizeof(I);
+        m.slack_bytes += (e.first->capacity() - e.first->size()) * sizeof(I);
+        m.padding_bytes += e.first->size() * interval_padding<I>();
+      }
+      return m;
+    }
+
+  private:
+    using lru_list = std::list<std::uint64_t>;
+
+    std::string path_;
+    detail::file_descriptor fd_;
+    interval_file_header h_{};
+    std::vector<value_type> fences_;
+    std::size_t capacity_;
+    mutable lru_list lru_;
+    mutable std::unordered_map<std::uint64_t,
+      std::pair<std::shared_ptr<page_type const>, lru_list::iterator>> cache_;
+    mutable cache_statistics stats_;
+
+    // the page whose first interval is the last to start at or before v,
+    // or pages() if there is none
+    std::uint64_t page_of(value_type v) const {
+      auto const k = std::upper_bound(fences_.begin(), fences_.end(), v) - fences_.begin();
+      return k == 0 ? h_.pages : static_cast<std::uint64_t>(k - 1);
+    }
+
+    std::shared_ptr<page_type const> read_page(std::uint64_t k) const {
+      std::vector<char> buf(h_.page_bytes);
+      fd_.read_at(buf.data(), buf.size(), (k + 1) * h_.page_bytes);
+      std::uint32_t count, crc;
+      std::memcpy(&count, buf.data(), 4);
+      std::memcpy(&crc, buf.data() + 4, 4);
+      auto const rs = detail::record_size<value_type>();
+      if (count == 0 || count > h_.records_per_page ||
+          detail::crc32(buf.data() + interval_file_page_header, count * rs) != crc)
+        throw std::runtime_error(path_ + ": corrupt page " + std::to_string(k));
+
+      auto p = std::make_shared<page_type>();
+      p->reserve(count);
+      for (std::uint32_t i = 0; i < count; ++i)
+        p->push_back(detail::decode_record<I>(buf.data() + interval_file_page_header + i * rs));
+      return p;
+    }
+  };
+
+  /**
+   * @brief Streams the union of two canonical ranges, such as paged sets,
+   *        into a file.
+   */
+  template <typename A, typename B, typename I>
+  void paged_union(A const & a, B const & b, interval_file_writer<I> & out) {
+    merge_disjoint_interval_sets(a.begin(), a.end(), b.begin(), b.end(),
+      [](bool x, bool y) { return x || y; }, [&out](I const & x) { out.push(x); });
+  }
+
+  /**
+   * @brief Streams the intersection of two canonical ranges into a file.
+   */
+  template <typename A, typename B, typename I>
+  void paged_intersection(A const & a, B const & b, interval_file_writer<I> & out) {
+    merge_disjoint_interval_sets(a.begin(), a.end(), b.begin(), b.end(),
+      [](bool x, bool y) { return x && y; }, [&out](I const & x) { out.push(x); });
+  }
+
+  /**
+   * @brief Streams the difference a - b of two canonical ranges into a file.
+   */
+  template <typename A, typename B, typename I>
+  void paged_difference(A const & a, B const & b, interval_file_writer<I> & out) {
+    merge_disjoint_interval_sets(a.begin(), a.end(), b.begin(), b.end(),
+      [](bool x, bool y) { return x && !y; }, [&out](I const & x) { out.push(x); });
+  }
+}
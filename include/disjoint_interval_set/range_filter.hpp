@@ -0,0 +1,211 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "disjoint_interval_set_algorithms.hpp"
+#include "disjoint_interval_set_memory.hpp"
+#include "interval.hpp"
+
+namespace disjoint_interval_set {
+  /**
+   * A compact approximate membership filter over a disjoint interval set,
+   * for rejecting probes without touching the set itself.
+   *
+   * The finite endpoints of the set, in order, are cut into segments that
+   * hold equally many of them, and each segment into a grid of equal
+   * buckets, one bit each; a bit is set if any interval reaches its bucket.
+   * Dense regions of the set thus get fine buckets and sparse ones coarse
+   * buckets. A probe finds its segment by binary search over the segment
+   * starts, about one per 32 intervals at the default density, and its
+   * bucket with one subtraction and one multiplication; a range probe
+   * tests the run of bits it spans a word at a time. Probes outside the
+   * set's hull are rejected exactly.
+   *
+   * Answers are one-sided: false means definitely not covered, true means
+   * possibly covered. Because the bucket of a value is monotone in the
+   * value, every covered point falls in a marked bucket, so there are no
+   * false negatives, even under rounding or with infinite endpoints.
+   *
+   * False positives come only from the buckets that hold an endpoint, and
+   * a segment of b buckets holds about 2b / bits_per_interval endpoints.
+   * So for a point probe drawn uniformly from within any segment, whatever
+   * the weights of the segments, the probability that it is a false
+   * positive is at most false_positive_bound(), about 2 /
+   * bits_per_interval. No filter of this size can bound the rate for every
+   * probe distribution: probes concentrated next to the endpoints, at a
+   * finer scale than the buckets there, pass whenever they miss the set.
+   * false_positive_rate() reports the realised rate for uniform probes
+   * over the whole span.
+   */
+  template <typename I>
+  class range_filter {
+  public:
+    using interval_type = I;
+    using value_type = typename I::value_type;
+
+    /**
+     * @brief Builds the filter from a set, with the given number of grid
+     *        bits per interval.
+     */
+    template <typename Set>
+    explicit range_filter(Set const & s, std::size_t bits_per_interval = 16) {
+      std::vector<I> v;
+      for (auto const & i : s)
+        if (!detail::vacuous(i)) v.push_back(i);
+      intervals_ = v.size();
+      if (v.empty()) return;
+
+      lo_ = v.front().left;
+      hi_ = v.back().right;
+      // the grid spans the finite endpoints; values beyond clamp to its ends
+      std::vector<double> e;
+      for (auto const & i : v) {
+        for (auto const x : {i.left, i.right}) {
+          auto const d = static_cast<double>(x);
+          if (std::isfinite(d)) e.push_back(d);
+        }
+      }
+      if (e.empty()) e.push_back(0);
+
+      // segment j starts at the endpoint of rank j |e| / segments, unless
+      // that value already starts a segment
+      auto const bits = std::max<std::size_t>(segment_bits, v.size() * bits_per_interval);
+      auto const segments = (bits + segment_bits - 1) / segment_bits;
+      for (std::size_t j = 0; j < segments; ++j) {
+        auto const k = e[j * e.size() / segments];
+        if (starts_.empty() || k > starts_.back()) starts_.push_back(k);
+      }
+      for (std::size_t j = 0; j < starts_.size(); ++j) {
+        auto const width = (j + 1 < starts_.size() ? starts_[j + 1] : e.back()) - starts_[j];
+        scales_.push_back(width > 0 ? segment_bits / width : 0);
+      }
+      buckets_ = starts_.size() * segment_bits;
+      bits_.assign(buckets_ / 64, 0);
+
+      double covered = 0;
+      for (auto const & i : v) {
+        mark(bucket(i.left), bucket(i.right));
+        covered += std::max(0.0, std::min(static_cast<double>(i.right), e.back()) -
+                                 std::max(static_cast<double>(i.left), e.front()));
+      }
+
+      // the buckets that hold an endpoint, the only partly covered ones
+      std::vector<std::uint64_t> edges(bits_.size(), 0);
+      for (auto const d : e) {
+        auto const b = bucket_of(d);
+        edges[b >> 6] |= std::uint64_t(1) << (b & 63);
+      }
+      double marked = 0;
+      for (std::size_t j = 0; j < starts_.size(); ++j) {
+        std::size_t m = 0, partial = 0;
+        for (auto w = j * segment_words; w < (j + 1) * segment_words; ++w) {
+          m += std::popcount(bits_[w]);
+          partial += std::popcount(edges[w]);
+        }
+        if (scales_[j] != 0) marked += m / scales_[j];
+        fpb_ = std::max(fpb_, static_cast<double>(partial) / segment_bits);
+      }
+
+      // uniform point probes over the grid that land in the set's gaps
+      auto const gaps = e.back() - e.front() - covered;
+      if (gaps > 0)
+        fpr_ = std::clamp((marked - covered) / gaps, 0.0, 1.0);
+    }
+
+    /**
+     * @brief False if v is definitely not in the set.
+     */
+    bool may_contain(value_type v) const {
+      if (intervals_ == 0 || v < lo_ || v > hi_) return false;
+      auto const b = bucket(v);
+      return bits_[b >> 6] >> (b & 63) & 1;
+    }
+
+    /**
+     * @brief False if q definitely does not intersect the set.
+     */
+    bool may_intersect(I const & q) const {
+      if (intervals_ == 0 || detail::vacuous(q) || q.right < lo_ || q.left > hi_)
+        return false;
+      auto const a = bucket(q.left), b = bucket(q.right);
+      auto const wa = a >> 6, wb = b >> 6;
+      auto const head = ~std::uint64_t(0) << (a & 63);
+      auto const tail = ~std::uint64_t(0) >> (63 - (b & 63));
+      if (wa == wb) return bits_[wa] & head & tail;
+      if (bits_[wa] & head) return true;
+      for (auto w = wa + 1; w < wb; ++w)
+        if (bits_[w]) return true;
+      return bits_[wb] & tail;
+    }
+
+    /**
+     * @brief The fraction of the uncovered span between the finite
+     *        endpoints that the filter fails to reject.
+     */
+    double false_positive_rate() const { return fpr_; }
+
+    /**
+     * @brief The greatest fraction of the buckets of a segment that hold an
+     *        endpoint: a bound on the false-positive rate of point probes
+     *        drawn uniformly from within segments.
+     */
+    double false_positive_bound() const { return fpb_; }
+
+    std::size_t buckets() const { return buckets_; }
+
+    memory_footprint memory_usage() const {
+      memory_footprint m;
+      m.intervals = intervals_;
+      m.heap_bytes = bits_.capacity() * sizeof(std::uint64_t) +
+                     (starts_.capacity() + scales_.capacity()) * sizeof(double);
+      m.slack_bytes = (bits_.capacity() - bits_.size()) * sizeof(std::uint64_t) +
+                      (starts_.capacity() - starts_.size() +
+                       scales_.capacity() - scales_.size()) * sizeof(double);
+      return m;
+    }
+
+  private:
+    static constexpr std::size_t segment_bits = 512;
+    static constexpr std::size_t segment_words = segment_bits / 64;
+
+    std::vector<std::uint64_t> bits_;
+    // the least value and the buckets per unit of each segment
+    std::vector<double> starts_;
+    std::vector<double> scales_;
+    std::size_t buckets_ = 0;
+    std::size_t intervals_ = 0;
+    value_type lo_{}, hi_{};
+    double fpr_ = 0;
+    double fpb_ = 0;
+
+    std::size_t bucket(value_type v) const { return bucket_of(static_cast<double>(v)); }
+
+    // monotone in d: the segments are in order, and rounding within one
+    // never moves a value past a larger one
+    std::size_t bucket_of(double d) const {
+      auto const j = std::max<std::ptrdiff_t>(
+        std::upper_bound(starts_.begin(), starts_.end(), d) - starts_.begin() - 1, 0);
+      auto const t = (d - starts_[j]) * scales_[j];
+      auto const b = !(t > 0) ? 0 :
+                     !(t < static_cast<double>(segment_bits)) ? segment_bits - 1 :
+                     static_cast<std::size_t>(t);
+      return static_cast<std::size_t>(j) * segment_bits + b;
+    }
+
+    void mark(std::size_t a, std::size_t b) {
+      auto const wa = a >> 6, wb = b >> 6;
+      auto const head = ~std::uint64_t(0) << (a & 63);
+      auto const tail = ~std::uint64_t(0) >> (63 - (b & 63));
+      if (wa == wb) {
+        bits_[wa] |= head & tail;
+        return;
+      }
+      bits_[wa] |= head;
+      for (auto w = wa + 1; w < wb; ++w) bits_[w] = ~std::uint64_t(0);
+      bits_[wb] |= tail;
+    }
+  };
+}
@@ -0,0 +1,206 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+#include "disjoint_interval_set_algorithms.hpp"
+#include "disjoint_interval_set_memory.hpp"
+#include "interval.hpp"
+
+namespace disjoint_interval_set {
+  /**
+   * An inverted index over a collection of disjoint interval sets that
+   * answers which sets contain a value, or intersect an interval.
+   *
+   * The distinct endpoints v_0 < ... < v_{m-1} of all sets cut the line
+   * into 2m + 1 elementary atoms: the gap before v_0, the point v_0, the
+   * gap (v_0, v_1), the point v_1, and so on. Membership in every set is
+   * constant on an atom. A segment tree over the atoms stores every
+   * interval in the O(log m) nodes of its canonical cover, so the index
+   * holds O(N log m) ids for N intervals instead of one per atom spanned.
+   * The ids of the intervals in order of their first atom are kept beside
+   * it, with a min-tree over the last atom of each one's predecessor in
+   * its own set. Both are kept in compressed sparse row form.
+   *
+   *  - stab(v) is a binary search for the atom of v and a walk up the
+   *    segment tree, O(log m + k log k) for k matches.
+   *  - intersecting(q) is stab of the first atom of q plus the sets whose
+   *    coverage resumes inside q. The min-tree reports each of those once,
+   *    from its first interval in q, O(log m + k log N) for k matches.
+   *
+   * Sets are identified by their position in the range the index is built
+   * from; a range of more sets than id_type can number is rejected with
+   * std::length_error.
+   */
+  template <typename I>
+  class stabbing_index {
+  public:
+    using interval_type = I;
+    using value_type = typename I::value_type;
+    using id_type = std::uint32_t;
+
+    template <typename Sets>
+    explicit stabbing_index(Sets const & sets) {
+      std::size_t count = 0;
+      for (auto const & s : sets) {
+        ++count;
+        for (auto const & i : s) {
+          values_.push_back(i.left);
+          values_.push_back(i.right);
+        }
+      }
+      if (count > std::numeric_limits<id_type>::max())
+        throw std::length_error("stabbing_index: more sets than id_type can number");
+      std::sort(values_.begin(), values_.end());
+      values_.erase(std::unique(values_.begin(), values_.end()), values_.end());
+
+      auto const atoms = 2 * values_.size() + 1;
+      leaves_ = std::bit_ceil(atoms);
+      std::vector<std::size_t> nodes(2 * leaves_ + 1, 0), begins(atoms + 1, 0);
+      std::vector<std::size_t> previous;
+
+      // count, then fill, the entries of every posting list
+      for (int pass = 0; pass < 2; ++pass) {
+        id_type id = 0;
+        for (auto const & s : sets) {
+          std::size_t resumes = 0; // one past the last atom of the previous interval
+          for (auto const & i : s) {
+            auto const a = left_atom(i), b = right_atom(i);
+            if (a > b) continue;
+            auto const place = [&](std::size_t n) {
+              if (pass == 0) ++nodes[n + 1];
+              else node_ids_[nodes[n]++] = id;
+            };
+            // the canonical cover of the leaves [a, b]
+            for (auto l = a + leaves_, r = b + leaves_ + 1; l < r; l /= 2, r /= 2) {
+              if (l % 2 == 1) place(l++);
+              if (r % 2 == 1) place(--r);
+            }
+            if (pass == 0) {
+              ++begins[a + 1];
+            } else {
+              previous[begins[a]] = resumes;
+              begin_ids_[begins[a]++] = id;
+            }
+            resumes = b + 1;
+          }
+          ++id;
+        }
+        if (pass == 0) {
+          std::partial_sum(nodes.begin(), nodes.end(), nodes.begin());
+          std::partial_sum(begins.begin(), begins.end(), begins.begin());
+          node_offsets_ = nodes;
+          begin_offsets_ = begins;
+          node_ids_.resize(nodes.back());
+          begin_ids_.resize(begins.back());
+          previous.resize(begins.back());
+        }
+      }
+
+      // a min-tree over previous, padded to a power of two
+      entries_ = std::bit_ceil(std::max<std::size_t>(previous.size(), 1));
+      resumes_.assign(2 * entries_, std::numeric_limits<std::size_t>::max());
+      std::copy(previous.begin(), previous.end(), resumes_.begin() + entries_);
+      for (auto k = entries_ - 1; k > 0; --k)
+        resumes_[k] = std::min(resumes_[2 * k], resumes_[2 * k + 1]);
+    }
+
+    /**
+     * @brief The ids of the sets that contain v, in ascending order.
+     */
+    std::vector<id_type> stab(value_type v) const {
+      std::vector<id_type> out;
+      covering(atom(v), out);
+      std::sort(out.begin(), out.end());
+      return out;
+    }
+
+    /**
+     * @brief The ids of the sets that intersect q, in ascending order.
+     */
+    std::vector<id_type> intersecting(I const & q) const {
+      if (detail::vacuous(q)) return {};
+      auto const a = left_atom(q), b = right_atom(q);
+      if (a > b) return {};
+
+      // the sets covering a, and those not covering a whose first interval
+      // after a begins by b; the two are disjoint and neither repeats a set
+      std::vector<id_type> out;
+      covering(a, out);
+      report(1, 0, entries_, begin_offsets_[a + 1], begin_offsets_[b + 1], a, out);
+      std::sort(out.begin(), out.end());
+      return out;
+    }
+
+    /**
+     * @brief The number of elementary atoms.
+     */
+    std::size_t atoms() const { return 2 * values_.size() + 1; }
+
+    memory_footprint memory_usage() const {
+      memory_footprint m;
+      m.heap_bytes = values_.capacity() * sizeof(value_type) +
+        (node_offsets_.capacity() + begin_offsets_.capacity() + resumes_.capacity()) * sizeof(std::size_t) +
+        (node_ids_.capacity() + begin_ids_.capacity()) * sizeof(id_type);
+      m.slack_bytes = (values_.capacity() - values_.size()) * sizeof(value_type) +
+        (node_ids_.capacity() - node_ids_.size() +
+         begin_ids_.capacity() - begin_ids_.size()) * sizeof(id_type);
+      m.intervals = begin_ids_.size();
+      return m;
+    }
+
+  private:
+    std::vector<value_type> values_;
+    std::size_t leaves_ = 1, entries_ = 1;
+    std::vector<std::size_t> node_offsets_, begin_offsets_, resumes_;
+    std::vector<id_type> node_ids_, begin_ids_;
+
+    // the ids stored on the path from the leaf of atom k to the root; an
+    // interval of a set covers at most one node of it, and only one
+    // interval of a set covers k, so no id repeats
+    void covering(std::size_t k, std::vector<id_type> & out) const {
+      for (auto n = k + leaves_; n > 0; n /= 2)
+        out.insert(out.end(), node_ids_.begin() + node_offsets_[n],
+                   node_ids_.begin() + node_offsets_[n + 1]);
+    }
+
+    // the ids of the entries in [from, to) whose set last left off at or
+    // before atom a, found by descending only into subtrees whose minimum
+    // says they hold one
+    void report(std::size_t n, std::size_t lo, std::size_t hi, std::size_t from,
+                std::size_t to, std::size_t a, std::vector<id_type> & out) const {
+      if (hi <= from || to <= lo || resumes_[n] > a) return;
+      if (hi - lo == 1) {
+        out.push_back(begin_ids_[lo]);
+        return;
+      }
+      auto const mid = lo + (hi - lo) / 2;
+      report(2 * n, lo, mid, from, to, a, out);
+      report(2 * n + 1, mid, hi, from, to, a, out);
+    }
+
+    // the atom holding v: 2i + 1 for the point v_i, 2i for the gap before it
+    std::size_t atom(value_type v) const {
+      auto const i = static_cast<std::size_t>(
+        std::lower_bound(values_.begin(), values_.end(), v) - values_.begin());
+      return (i != values_.size() && values_[i] == v) ? 2 * i + 1 : 2 * i;
+    }
+
+    // the first and the last atom an interval covers
+    std::size_t left_atom(I const & x) const {
+      auto const a = atom(x.left);
+      return (a % 2 == 1 && x.left_open) ? a + 1 : a;
+    }
+
+    std::size_t right_atom(I const & x) const {
+      auto const a = atom(x.right);
+      // an open right end at v_i stops at the gap before it; a value between
+      // endpoints already lies in a gap
+      return (a % 2 == 1 && x.right_open) ? a - 1 : a;
+    }
+  };
+}
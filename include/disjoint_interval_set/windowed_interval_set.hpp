@@ -0,0 +1,164 @@
+#pragma once
+
+#include <cmath>
+#include <deque>
+#include <type_traits>
+#include "disjoint_interval_set.hpp"
+#include "disjoint_interval_set_algorithms.hpp"
+#include "disjoint_interval_set_hash.hpp"
+#include "disjoint_interval_set_memory.hpp"
+#include "interval.hpp"
+
+namespace disjoint_interval_set {
+  /**
+   * The union of a stream of intervals over a sliding window of width W.
+   *
+   * The set tracks now, the greatest finite right endpoint seen (or the time passed
+   * to advance()), and holds the union of everything inserted clipped to
+   * the window (now - W, +inf). Its canonical intervals live in a deque:
+   *
+   *  - an interval that starts after the last one is fused with it or
+   *    appended at the tail, in amortized O(1);
+   *  - intervals that fall out of the window are popped from the head,
+   *    O(1) each, and the new head is clipped to the window;
+   *  - a late interval that starts no later than the tail is merged into
+   *    place with a binary search, in O(n) time for the shift.
+   *
+   * The fingerprint of the window is kept up to date as intervals are
+   * fused, added and expired.
+   */
+  template <typename I = interval<double>>
+  class windowed_interval_set {
+  public:
+    using interval_type = I;
+    using value_type = typename I::value_type;
+    using const_iterator = typename std::deque<I>::const_iterator;
+
+    /**
+     * @brief Constructs an empty set over a window of the given width,
+     *        with the window ending at now.
+     */
+    explicit windowed_interval_set(value_type width, value_type now = value_type(0)) :
+      width_(width), now_(now) {}
+
+    /**
+     * @brief Adds x, moving the window forward to x's right endpoint if it
+     *        lies ahead of it. An empty x changes nothing, and an infinite
+     *        right endpoint does not move the window: x is clipped to the
+     *        horizon and, reaching past any later now, never expires.
+     */
+    void insert(I x) {
+      if (detail::vacuous(x)) return;
+      if (now_ < x.right && finite(x.right)) {
+        now_ = x.right;
+        expire();
+      }
+      if (!clip(x)) return;
+
+      // past the start of the tail only the tail can absorb x
+      if (s_.empty() || s_.back().left < x.left) {
+        if (!s_.empty() && detail::mergeable(s_.back(), x)) {
+          fp_ -= detail::interval_hash(s_.back());
+          s_.back() = detail::hull(s_.back(), x);
+          fp_ += detail::interval_hash(s_.back());
+        } else {
+          s_.push_back(x);
+          fp_ += detail::interval_hash(x);
+        }
+        return;
+      }
+
+      auto [lo, hi, merged] = detail::absorb(s_.begin(), s_.end(), x);
+      for (auto i = lo; i != hi; ++i) fp_ -= detail::interval_hash(*i);
+      fp_ += detail::interval_hash(merged);
+      if (lo == hi) {
+        s_.insert(lo, merged);
+      } else {
+        *lo = merged;
+        s_.erase(lo + 1, hi);
+      }
+    }
+
+    /**
+     * @brief Moves the end of the window forward to now, expiring what
+     *        falls out of it.
+     */
+    void advance(value_type now) {
+      if (!(now_ < now)) return;
+      now_ = now;
+      expire();
+    }
+
+    /**
+     * @brief The exclusive left edge of the window, now - W.
+     */
+    value_type horizon() const { return now_ - width_; }
+    value_type now() const { return now_; }
+    value_type width() const { return width_; }
+
+    bool contains(value_type v) const {
+      return detail::sorted_contains(s_.begin(), s_.end(), v);
+    }
+
+    /**
+     * @brief The fingerprint of the window, in O(1); equal to
+     *        fingerprint(to_set()).
+     */
+    std::uint64_t fingerprint() const { return fp_; }
+
+    auto size() const { return s_.size(); }
+    auto empty() const { return s_.empty(); }
+    auto begin() const { return s_.begin(); }
+    auto end() const { return s_.end(); }
+
+    /**
+     * @brief A snapshot of the window as a disjoint_interval_set, in memory
+     *        from a.
+     */
+    template <typename A = std::allocator<I>>
+    disjoint_interval_set<I, A> to_set(A const & a = A()) const {
+      return disjoint_interval_set<I, A>(s_.begin(), s_.end(), a);
+    }
+
+    memory_footprint memory_usage() const {
+      memory_footprint m;
+      m.intervals = s_.size();
+      // counts the elements, not the deque's block map and partial blocks
+      m.heap_bytes = s_.size() * sizeof(I);
+      m.padding_bytes = s_.size() * interval_padding<I>();
+      return m;
+    }
+
+  private:
+    std::deque<I> s_;
+    value_type width_;
+    value_type now_;
+    std::uint64_t fp_ = 0;
+
+    static bool finite(value_type v) {
+      if constexpr (std::is_floating_point_v<value_type>)
+        return std::isfinite(v);
+      else
+        return true;
+    }
+
+    // clips x to the window; false if nothing of x is left
+    bool clip(I & x) const {
+      auto const h = horizon();
+      if (x.left < h || (x.left == h && !x.left_open))
+        x = I(h, x.right, true, x.right_open);
+      return !detail::vacuous(x);
+    }
+
+    void expire() {
+      while (!s_.empty()) {
+        fp_ -= detail::interval_hash(s_.front());
+        if (clip(s_.front())) {
+          fp_ += detail::interval_hash(s_.front());
+          return;
+        }
+        s_.pop_front();
+      }
+    }
+  };
+}
@@ -0,0 +1,193 @@
+/**
+ * Tests of adaptive_interval_set: every layout agrees with a reference
+ * under random inserts and erasures, keeps its fingerprint, and migrates
+ * where its thresholds say.
+ *
+ *   g++ -std=c++20 -Iinclude tests/adaptive_interval_set_test.cpp -o adaptive_interval_set_test
+ *   ./adaptive_interval_set_test
+ */
+
+#include <disjoint_interval_set/adaptive_interval_set.hpp>
+
+#include <cassert>
+#include <climits>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace disjoint_interval_set;
+
+namespace {
+  using I = interval<int>;
+  using D = interval<double>;
+
+  // the maximal runs of set values in b, as closed intervals
+  std::vector<I> runs(std::vector<bool> const & b) {
+    std::vector<I> v;
+    int const n = static_cast<int>(b.size());
+    for (int i = 0; i < n;) {
+      if (!b[i]) { ++i; continue; }
+      auto j = i;
+      while (j + 1 < n && b[j + 1]) ++j;
+      v.push_back(I(i, j));
+      i = j + 1;
+    }
+    return v;
+  }
+
+  template <typename J>
+  bool same(std::vector<J> const & x, std::vector<J> const & y) {
+    if (x.size() != y.size()) return false;
+    for (std::size_t k = 0; k < x.size(); ++k)
+      if (x[k].left != y[k].left || x[k].right != y[k].right ||
+          x[k].left_open != y[k].left_open || x[k].right_open != y[k].right_open)
+        return false;
+    return true;
+  }
+
+  // thresholds that hold a set in one layout, or push it into another
+  std::vector<adaptive_thresholds> layouts() {
+    adaptive_thresholds stay, sorted, tree, bitmap;
+    stay.check_every = 1000000;
+    sorted.bitmap_max_bits = 0;
+    sorted.tree_min_intervals = 1000000;
+    tree.bitmap_max_bits = 0;
+    tree.tree_min_intervals = 0;
+    tree.tree_min_update_ratio = 0;
+    tree.check_every = 1;
+    bitmap.bitmap_min_intervals = 0;
+    bitmap.bitmap_max_bits_per_interval = 1 << 20;
+    bitmap.check_every = 1;
+    return {stay, sorted, tree, bitmap};
+  }
+
+  void every_layout_agrees_with_a_reference() {
+    std::mt19937 g(1);
+    auto const ts = layouts();
+    for (int round = 0; round < 100; ++round) {
+      std::vector<adaptive_interval_set<I, 4>> s(ts.size());
+      for (std::size_t k = 0; k < ts.size(); ++k) s[k].set_thresholds(ts[k]);
+      std::vector<bool> b(200);
+      for (int op = 0; op < 300; ++op) {
+        int const l = g() % 200;
+        auto const r = std::min(199, l + static_cast<int>(g() % (round % 3 == 0 ? 4 : 30)));
+        bool const lo = g() % 2, ro = g() % 2;
+        bool const add = g() % 3 != 0;
+        for (auto & x : s) add ? x.insert(I(l, r, lo, ro)) : x.erase(I(l, r, lo, ro));
+        for (auto v = lo ? l + 1 : l; v <= (ro ? r - 1 : r); ++v) b[v] = add;
+
+        auto const expected = runs(b);
+        for (auto const & x : s) {
+          assert(same(x.intervals(), expected));
+          assert(x.size() == expected.size());
+          assert(x.fingerprint() == fingerprint(expected));
+          for (int q = 0; q < 5; ++q) {
+            auto const v = static_cast<int>(g() % 200);
+            assert(x.contains(v) == b[v]);
+          }
+        }
+      }
+    }
+  }
+
+  void migrates_where_the_thresholds_say() {
+    auto const ts = layouts();
+    std::vector<adaptive_interval_set<I, 4>> s(ts.size());
+    for (std::size_t k = 0; k < ts.size(); ++k) s[k].set_thresholds(ts[k]);
+    for (int v = 0; v < 400; v += 2)
+      for (auto & x : s) x.insert(I(v, v));
+    assert(s[1].layout() == representation::sorted);
+    assert(s[2].layout() == representation::tree);
+    assert(s[3].layout() == representation::bitmap);
+    for (auto const & x : s) {
+      assert(x.size() == 200);
+      assert(x.memory_usage().intervals == 200 || x.layout() == representation::bitmap);
+    }
+    assert(s[3].statistics().migrations != 0);
+    assert(s[3].statistics().density > 0.4);
+
+    adaptive_interval_set<I, 4> small;
+    small.insert(I(0, 1));
+    assert(small.layout() == representation::small);
+    assert(small.memory_usage().heap_bytes == 0);
+  }
+
+  void integral_endpoints_are_canonical() {
+    adaptive_interval_set<I> e;
+    e.insert(I(INT_MIN, INT_MAX));
+    e.erase(I(0, 0));
+    assert(e.size() == 2 && !e.contains(0) && e.contains(INT_MIN) && e.contains(INT_MAX));
+    e.insert(I(0, 1, true, true));
+    assert(e.size() == 2);
+    e.insert(I(-1, 1, true, true));
+    assert(e.size() == 1);
+
+    // adjacent integers fuse when the set is built from another
+    ::disjoint_interval_set::disjoint_interval_set<I> const ds(
+      std::vector<I>{I(1, 2), I(3, 4), I(6, 8, true, true)});
+    adaptive_interval_set<I> const c(ds);
+    assert(same(c.intervals(), std::vector<I>{I(1, 4), I(7, 7)}));
+    assert(c.to_set() == ::disjoint_interval_set::disjoint_interval_set<I>(c.intervals()));
+  }
+
+  void bitmap_domains_grow_both_ways_and_reach_the_ends() {
+    adaptive_thresholds t;
+    t.bitmap_min_intervals = 0;
+    t.bitmap_max_bits_per_interval = 1 << 20;
+    t.check_every = 1;
+
+    // headroom below and above: growing a little either way stays put
+    std::vector<I> points;
+    for (int v = 1000; v < 2000; v += 2) points.push_back(I(v, v));
+    adaptive_interval_set<I, 4> g(::disjoint_interval_set::disjoint_interval_set<I>(points), t);
+    assert(g.layout() == representation::bitmap);
+    auto const migrations = g.statistics().migrations;
+    g.insert(I(950, 950));
+    g.insert(I(2050, 2050));
+    assert(g.layout() == representation::bitmap && g.statistics().migrations == migrations);
+    assert(g.contains(950) && g.contains(2050) && g.size() == 502);
+    assert(g.statistics().span == 2050 - 950 + 1);
+
+    // the summary levels are heap in use, not slack
+    g.shrink_to_fit();
+    assert(g.memory_usage().slack_bytes == 0 && g.memory_usage().heap_bytes != 0);
+
+    // domains at either end of int, where base + bits would overflow
+    adaptive_interval_set<I, 4> hi(t), lo(t);
+    for (int k = 0; k < 100; ++k) {
+      hi.insert(I(INT_MAX - 2 * k, INT_MAX - 2 * k));
+      lo.insert(I(INT_MIN + 2 * k, INT_MIN + 2 * k));
+    }
+    assert(hi.layout() == representation::bitmap && lo.layout() == representation::bitmap);
+    assert(hi.contains(INT_MAX) && !hi.contains(INT_MAX - 1) && hi.size() == 100);
+    assert(lo.contains(INT_MIN) && !lo.contains(INT_MIN + 1) && lo.size() == 100);
+    hi.erase(I(INT_MAX - 10, INT_MAX));
+    assert(hi.size() == 94 && !hi.contains(INT_MAX) && hi.contains(INT_MAX - 12));
+
+    // an interval across all of int leaves the domain without overflowing
+    lo.insert(I(INT_MIN, INT_MAX));
+    assert(lo.size() == 1 && lo.layout() != representation::bitmap);
+    assert(lo.contains(INT_MIN) && lo.contains(0) && lo.contains(INT_MAX));
+  }
+
+  void real_endpoints_keep_their_openness() {
+    adaptive_interval_set<D> d;
+    d.insert(D(1, 3, true, true));
+    d.erase(D(2, 2));
+    assert(same(d.intervals(), std::vector<D>{D(1, 2, true, true), D(2, 3, true, true)}));
+    assert(!d.contains(2) && d.contains(2.5) && !d.contains(1));
+    d.insert(D(2, 2));
+    assert(d.size() == 1);
+    d.erase(D(0, 10));
+    assert(d.empty());
+  }
+}
+
+int main() {
+  every_layout_agrees_with_a_reference();
+  migrates_where_the_thresholds_say();
+  integral_endpoints_are_canonical();
+  bitmap_domains_grow_both_ways_and_reach_the_ends();
+  real_endpoints_keep_their_openness();
+  std::puts("adaptive_interval_set_test: ok");
+}
@@ -0,0 +1,104 @@
+/**
+ * Tests of huge_page_allocator and of sets that carry an allocator through
+ * their operations.
+ *
+ *   g++ -std=c++20 -Iinclude tests/allocator_test.cpp -o allocator_test
+ *   ./allocator_test
+ */
+
+#include <disjoint_interval_set/disjoint_interval_set.hpp>
+#include <disjoint_interval_set/disjoint_interval_set_allocator.hpp>
+
+#include <cassert>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <memory_resource>
+#include <vector>
+
+using namespace disjoint_interval_set;
+
+namespace {
+  using I = interval<double>;
+
+  void small_and_large_blocks() {
+    huge_page_allocator<I> a;
+    auto const before = huge_page_allocator<I>::statistics();
+
+    // below the threshold: operator new, not counted
+    auto * p = a.allocate(16);
+    p[15] = I(0, 1);
+    a.deallocate(p, 16);
+    assert(huge_page_allocator<I>::statistics().mapped == before.mapped);
+
+    // above it: a direct mapping, 2 MB aligned, writable to the end
+    std::size_t const n = (std::size_t(4) << 20) / sizeof(I);
+    auto * q = a.allocate(n);
+    assert(reinterpret_cast<std::uintptr_t>(q) % (std::size_t(2) << 20) == 0);
+    q[0] = I(0, 1);
+    q[n - 1] = I(2, 3);
+    a.deallocate(q, n);
+#ifdef __linux__
+    assert(huge_page_allocator<I>::statistics().mapped == before.mapped + 1);
+#endif
+  }
+
+  void sets_work_in_huge_pages() {
+    using set = ::disjoint_interval_set::disjoint_interval_set<I, huge_page_allocator<I>>;
+    std::vector<I> v;
+    for (int k = 0; k < 200000; ++k) v.emplace_back(3.0 * k, 3.0 * k + 1);
+    set const s(v.begin(), v.end());
+    assert(s.size() == v.size() && s.contains(3) && !s.contains(2));
+    auto const c = ~s;
+    assert(c.size() == s.size() + 1 && (s + c).size() == 1);
+  }
+
+  void an_empty_mask_is_a_placement_failure() {
+    huge_page_options o;
+    o.placement = numa_policy::bind;
+    o.nodes = 0;
+    huge_page_allocator<I> a(o);
+    auto const before = huge_page_allocator<I>::statistics();
+    std::size_t const n = (std::size_t(2) << 20) / sizeof(I);
+    auto * p = a.allocate(n);
+    p[0] = I(0, 1);
+    a.deallocate(p, n);
+#ifdef __linux__
+    auto const after = huge_page_allocator<I>::statistics();
+    assert(after.placement_failures == before.placement_failures + 1);
+    assert(after.last_placement_error == EINVAL);
+#else
+    (void)before;
+#endif
+  }
+
+  void results_use_the_operands_allocator() {
+    using A = std::pmr::polymorphic_allocator<I>;
+    using set = ::disjoint_interval_set::disjoint_interval_set<I, A>;
+    std::pmr::monotonic_buffer_resource res;
+    std::vector<set> v;
+    v.reserve(3);
+    v.emplace_back(std::vector<I>{I(0, 2)}, A(&res));
+    v.emplace_back(std::vector<I>{I(1, 3)}, A(&res));
+    v.emplace_back(std::vector<I>{I(1.5, 5)}, A(&res));
+    assert(v[0].get_allocator().resource() == &res);
+
+    auto const r = at_least_k(v, 2);
+    assert(r.get_allocator().resource() == &res);
+    assert(r.size() == 1 && r.begin()->left == 1 && r.begin()->right == 3);
+    auto const u = at_least_k(v, 0);
+    assert(u.size() == 1 && std::isinf(u.begin()->left));
+
+    std::vector<::disjoint_interval_set::disjoint_interval_set<interval<int>>> const none;
+    assert(at_least_k(none, 0).size() == 1 && at_least_k(none, 1).empty());
+  }
+}
+
+int main() {
+  small_and_large_blocks();
+  sets_work_in_huge_pages();
+  an_empty_mask_is_a_placement_failure();
+  results_use_the_operands_allocator();
+  std::puts("allocator_test: ok");
+}
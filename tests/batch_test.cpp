@@ -0,0 +1,61 @@
+/**
+ * Tests of batch_locate and batch_contains against one lookup at a time,
+ * over group sizes that do and do not divide the number of queries.
+ *
+ *   g++ -std=c++20 -Iinclude tests/batch_test.cpp -o batch_test
+ *   ./batch_test
+ */
+
+#include <disjoint_interval_set/disjoint_interval_set.hpp>
+#include <disjoint_interval_set/disjoint_interval_set_batch.hpp>
+
+#include <cassert>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace disjoint_interval_set;
+
+namespace {
+  using I = interval<double>;
+  using set = ::disjoint_interval_set::disjoint_interval_set<I>;
+
+  template <std::size_t G>
+  void agrees_with_contains(set const & s, std::vector<double> const & q) {
+    std::vector<I> const v(s.begin(), s.end());
+    auto const at = batch_locate<G>(s, q);
+    auto const in = batch_contains<G>(s, q);
+    assert(at.size() == q.size() && in.size() == q.size());
+    for (std::size_t k = 0; k < q.size(); ++k) {
+      assert(in[k] == s.contains(q[k]));
+      if (in[k]) assert(v[at[k]].contains(q[k]));
+      else assert(at[k] == v.size());
+    }
+  }
+
+  template <std::size_t G>
+  void every_size(std::mt19937 & g) {
+    for (std::size_t n : {0, 1, 2, 3, 17, 1000}) {
+      std::vector<I> v;
+      for (std::size_t k = 0; k < n; ++k) v.emplace_back(3.0 * k, 3.0 * k + 1, k % 2 == 0, k % 3 == 0);
+      set const s(v);
+      std::uniform_real_distribution<double> x(-2, 3.0 * n + 2);
+      for (std::size_t m : {0, 1, 5, 16, 33, 1000}) {
+        std::vector<double> q(m);
+        for (auto & y : q) y = x(g);
+        // the endpoints themselves, open and closed
+        for (std::size_t k = 0; k < n && k < m; ++k) q[k] = (k % 2 == 0) ? 3.0 * k : 3.0 * k + 1;
+        agrees_with_contains<G>(s, q);
+      }
+    }
+  }
+}
+
+int main() {
+  std::mt19937 g(14);
+  every_size<1>(g);
+  every_size<3>(g);
+  every_size<8>(g);
+  every_size<16>(g);
+  std::puts("batch_test: ok");
+}
@@ -0,0 +1,99 @@
+/**
+ * Tests of result_cache: hits, commutative keys, LRU eviction within the
+ * budget and verified hits.
+ *
+ *   g++ -std=c++20 -Iinclude tests/cache_test.cpp -o cache_test
+ *   ./cache_test
+ */
+
+#include <disjoint_interval_set/disjoint_interval_set_cache.hpp>
+
+#include <cassert>
+#include <cstdio>
+#include <vector>
+
+using namespace disjoint_interval_set;
+
+namespace {
+  using I = interval<double>;
+  using set = ::disjoint_interval_set::disjoint_interval_set<I>;
+
+  set make(std::vector<I> const & v) { return set(v.begin(), v.end()); }
+
+  void results_are_memoized() {
+    result_cache<set> c;
+    auto const a = c.operand(make({I(0, 2)})), b = c.operand(make({I(1, 3)}));
+
+    auto const u = c.unite(a, b);
+    assert(*u == make({I(0, 3)}));
+    assert(c.statistics().misses == 1 && c.statistics().hits == 0);
+    assert(c.unite(a, b).set == u.set);
+    assert(c.unite(b, a).set == u.set);
+    assert(c.statistics().hits == 2);
+
+    // a - b and b - a are different operations
+    auto const d1 = c.subtract(a, b), d2 = c.subtract(b, a);
+    assert(*d1 == make({I(0, 1, false, true)}));
+    assert(*d1 != *d2);
+    assert(*c.intersect(a, b) == make({I(1, 2)}));
+    assert(*c.symmetric_difference(a, b) == (*a ^ *b));
+    assert(*c.complement(a) == ~*a);
+    assert(c.statistics().entries == 6);
+
+    // nested expressions are answered from the cache once seen
+    auto const e = c.intersect(c.unite(a, b), c.complement(a));
+    auto const hits = c.statistics().hits;
+    assert(c.intersect(c.unite(a, b), c.complement(a)).set == e.set);
+    assert(c.statistics().hits == hits + 3);
+  }
+
+  void evicts_least_recently_used_within_the_budget() {
+    std::vector<result_cache<set>::handle> ops;
+    for (int k = 0; k < 20; ++k)
+      ops.push_back(result_cache<set>::operand(make({I(k, k + 0.5)})));
+
+    result_cache<set> c(4096);
+    std::vector<result_cache<set>::handle> results;
+    for (int k = 0; k + 1 < 20; ++k) results.push_back(c.unite(ops[k], ops[k + 1]));
+    auto const s = c.statistics();
+    assert(s.bytes <= c.budget());
+    assert(s.evictions != 0 && s.entries + s.evictions == 19);
+    // evicted results stay valid in the hands of callers
+    assert(*results[0] == make({I(0, 0.5), I(1, 1.5)}));
+
+    c.set_budget(0);
+    assert(c.statistics().entries == 0 && c.statistics().bytes == 0);
+    c.unite(ops[0], ops[1]);
+    assert(c.statistics().entries == 0);
+
+    c.set_budget(1 << 20);
+    c.unite(ops[0], ops[1]);
+    c.clear();
+    assert(c.statistics().entries == 0);
+  }
+
+  void verified_hits_catch_collisions() {
+    result_cache<set> c(1 << 20, true);
+    assert(c.verify_hits());
+    auto const a = c.operand(make({I(0, 1)})), b = c.operand(make({I(2, 3)}));
+    auto const u = c.unite(a, b);
+
+    // forge a collision: a's fingerprint over other contents
+    auto f = c.operand(make({I(5, 6)}));
+    f.fingerprint = a.fingerprint;
+    assert(*c.unite(f, b) == make({I(2, 3), I(5, 6)}));
+    assert(c.statistics().collisions == 1);
+
+    // without verification the entry of a + b is served as is
+    c.set_verify_hits(false);
+    assert(c.unite(f, b).set == u.set);
+    assert(c.statistics().collisions == 1);
+  }
+}
+
+int main() {
+  results_are_memoized();
+  evicts_least_recently_used_within_the_budget();
+  verified_hits_catch_collisions();
+  std::puts("cache_test: ok");
+}
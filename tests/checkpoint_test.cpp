@@ -0,0 +1,152 @@
+/**
+ * Tests of checkpoint and restore: round trips, atomic replacement under
+ * concurrent checkpoints, and corruption found when a page is reached.
+ *
+ *   g++ -std=c++20 -pthread -Iinclude tests/checkpoint_test.cpp -o checkpoint_test
+ *   ./checkpoint_test
+ */
+
+#include <disjoint_interval_set/disjoint_interval_set_checkpoint.hpp>
+
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace disjoint_interval_set;
+
+namespace {
+  using I = interval<double>;
+  using set = ::disjoint_interval_set::disjoint_interval_set<I>;
+
+  std::string temp_dir() {
+    char const * t = std::getenv("TMPDIR");
+    std::string pattern = std::string(t ? t : "/tmp") + "/checkpoint_test-XXXXXX";
+    if (!::mkdtemp(pattern.data())) throw std::runtime_error("mkdtemp");
+    return pattern;
+  }
+
+  std::size_t entries(std::string const & dir) {
+    std::size_t n = 0;
+    auto * d = ::opendir(dir.c_str());
+    while (auto * e = ::readdir(d))
+      if (e->d_name[0] != '.') ++n;
+    ::closedir(d);
+    return n;
+  }
+
+  std::vector<I> stripes(int offset, int n) {
+    std::vector<I> v;
+    for (int k = 0; k < n; ++k) v.emplace_back(10 * k + offset, 10 * k + offset + 1, k % 2 == 0, false);
+    return v;
+  }
+
+  void round_trips(std::string const & dir) {
+    auto const path = dir + "/set";
+    set const s(stripes(0, 50000));
+    assert(checkpoint(s, path) == s.size());
+    auto const m = restore<I>(path);
+    assert(m.size() == s.size());
+    assert(m.to_set() == s);
+    for (int k = 0; k < 50000; k += 97) {
+      assert(m.contains(10 * k + 0.5) && !m.contains(10 * k + 5));
+      assert(m.contains(10 * k) == (k % 2 != 0));
+    }
+    m.validate();
+
+    struct stat st;
+    assert(::stat(path.c_str(), &st) == 0 && (st.st_mode & 0777) == 0644);
+
+    // overwriting replaces the whole file
+    checkpoint(set(stripes(3, 10)), path);
+    assert(restore<I>(path).size() == 10);
+    ::unlink(path.c_str());
+  }
+
+  void concurrent_checkpoints_never_interleave(std::string const & dir) {
+    auto const path = dir + "/shared";
+    std::vector<std::vector<I>> sets;
+    for (int t = 0; t < 8; ++t) sets.push_back(stripes(t, 20000));
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t)
+      threads.emplace_back([&, t] { for (int k = 0; k < 5; ++k) checkpoint(sets[t], path); });
+    for (auto & t : threads) t.join();
+
+    // the file is one writer's set in full, and no temporary is left
+    auto const m = restore<I>(path);
+    m.validate();
+    assert(m.size() == 20000);
+    auto const t = static_cast<int>((*m.begin()).left);
+    assert(t >= 0 && t < 8);
+    assert(m.to_set() == set(sets[t]));
+    assert(entries(dir) == 1);
+    ::unlink(path.c_str());
+  }
+
+  void corruption_is_found_where_it_is(std::string const & dir) {
+    auto const path = dir + "/corrupt";
+    checkpoint(set(stripes(0, 10000)), path, 4096);
+    {
+      // flip a bit in a record of the last page
+      std::fstream f(path, std::ios::in | std::ios::out | std::ios::binary);
+      f.seekg(0, std::ios::end);
+      auto const size = static_cast<std::size_t>(f.tellg());
+      auto const pages = (10000 + 239) / 240; // (4096 - 8) / 17 records a page
+      auto const at = static_cast<std::streamoff>(pages * 4096 + 100);
+      assert(static_cast<std::size_t>(at) < size);
+      char c;
+      f.seekg(at);
+      f.get(c);
+      f.seekp(at);
+      f.put(static_cast<char>(c ^ 1));
+    }
+    auto const m = restore<I>(path);
+    assert(m.contains(0.5));
+    bool threw = false;
+    try {
+      m.validate();
+    } catch (std::runtime_error const &) {
+      threw = true;
+    }
+    assert(threw);
+    ::unlink(path.c_str());
+
+    // a page too small for the header is refused before anything is
+    // written, and the old checkpoint stays
+    auto const kept = dir + "/kept";
+    checkpoint(set(stripes(0, 10)), kept);
+    threw = false;
+    try {
+      checkpoint(set(stripes(0, 20)), kept, 32);
+    } catch (std::invalid_argument const &) {
+      threw = true;
+    }
+    assert(threw && entries(dir) == 1 && restore<I>(kept).size() == 10);
+    ::unlink(kept.c_str());
+
+    threw = false;
+    try {
+      restore<I>(dir + "/missing");
+    } catch (std::runtime_error const &) {
+      threw = true;
+    }
+    assert(threw);
+  }
+}
+
+int main() {
+  auto const dir = temp_dir();
+  round_trips(dir);
+  concurrent_checkpoints_never_interleave(dir);
+  corruption_is_found_where_it_is(dir);
+  assert(entries(dir) == 0);
+  ::rmdir(dir.c_str());
+  std::puts("checkpoint_test: ok");
+}
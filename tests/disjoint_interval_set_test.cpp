@@ -0,0 +1,210 @@
+/**
+ * Tests of the operations on disjoint_interval_set: construction, the
+ * set-theoretic operators, at_least_k, the streaming merge, histograms,
+ * the morphological operations, shift and scale, grid snapping and
+ * memory_usage.
+ *
+ *   g++ -std=c++20 -Iinclude tests/disjoint_interval_set_test.cpp -o disjoint_interval_set_test
+ *   ./disjoint_interval_set_test
+ */
+
+#include <disjoint_interval_set/disjoint_interval_set.hpp>
+
+#include <cassert>
+#include <cstdio>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+  using I = disjoint_interval_set::interval<double>;
+  using set = disjoint_interval_set::disjoint_interval_set<I>;
+
+  set make(std::vector<I> const & v) { return set(v.begin(), v.end()); }
+
+  bool same(set const & x, std::vector<I> const & v) {
+    if (x.size() != v.size()) return false;
+    auto j = v.begin();
+    for (auto const & i : x) {
+      if (i.left != j->left || i.right != j->right ||
+          i.left_open != j->left_open || i.right_open != j->right_open)
+        return false;
+      ++j;
+    }
+    return true;
+  }
+
+  // random sets over small integer endpoints with random openness, so that
+  // every case of shared and touching endpoints comes up
+  set random_set(std::mt19937 & g) {
+    std::uniform_int_distribution<int> pos(0, 40), len(0, 6), coin(0, 1), count(0, 6);
+    std::vector<I> v;
+    for (int n = count(g); n > 0; --n) {
+      auto const l = pos(g);
+      v.emplace_back(l, l + len(g), coin(g) == 1, coin(g) == 1);
+    }
+    return make(v);
+  }
+
+  // the integers and the half integers over the range of random_set
+  std::vector<double> probes() {
+    std::vector<double> p;
+    for (int k = -2; k <= 100; ++k) p.push_back(k / 2.0);
+    return p;
+  }
+
+  bool canonical(set const & x) {
+    for (auto i = x.begin(); i != x.end(); ++i) {
+      if (disjoint_interval_set::detail::vacuous(*i)) return false;
+      if (i != x.begin()) {
+        auto const & p = *std::prev(i);
+        if (p.right > i->left) return false;
+        if (p.right == i->left && !(p.right_open && i->left_open)) return false;
+      }
+    }
+    return true;
+  }
+
+  void construction_coalesces() {
+    auto const x = make({I(3, 4), I(0, 1), I(1, 2, true, false), I(5, 6, true, true)});
+    assert(same(x, {I(0, 2), I(3, 4), I(5, 6, true, true)}));
+    assert(x.contains(1) && !x.contains(5) && x.contains(5.5));
+    assert(make({}).empty());
+  }
+
+  void operators_are_boolean_operations() {
+    std::mt19937 g(2);
+    for (int round = 0; round < 300; ++round) {
+      auto const a = random_set(g), b = random_set(g);
+      auto const u = a + b, i = a * b, d = a - b, c = ~a;
+      assert(canonical(u) && canonical(i) && canonical(d) && canonical(c));
+      for (auto p : probes()) {
+        assert(u.contains(p) == (a.contains(p) || b.contains(p)));
+        assert(i.contains(p) == (a.contains(p) && b.contains(p)));
+        assert(d.contains(p) == (a.contains(p) && !b.contains(p)));
+        assert(c.contains(p) == !a.contains(p));
+      }
+      assert(i <= a && i <= b && a <= u && b <= u);
+      assert(a == a && (a == b) == (a <= b && b <= a));
+    }
+  }
+
+  void memory_usage_counts_the_buffer() {
+    auto x = make({I(0, 1), I(2, 3), I(4, 5)});
+    auto const m = x.memory_usage();
+    assert(m.intervals == 3);
+    assert(m.heap_bytes >= 3 * sizeof(I));
+    x.shrink_to_fit();
+    assert(x.memory_usage().slack_bytes == 0);
+  }
+
+  void at_least_k_counts_coverage() {
+    std::mt19937 g(1);
+    for (int round = 0; round < 300; ++round) {
+      std::vector<set> sets;
+      for (int n = 1 + round % 5; n > 0; --n) sets.push_back(random_set(g));
+      for (std::size_t k = 1; k <= sets.size() + 1; ++k) {
+        auto const r = at_least_k(sets, k);
+        assert(canonical(r));
+        for (auto p : probes()) {
+          std::size_t covering = 0;
+          for (auto const & s : sets) covering += s.contains(p);
+          assert(r.contains(p) == (covering >= k));
+        }
+      }
+    }
+
+    std::vector<set> const none;
+    assert(at_least_k(none, 1).empty());
+    auto const everything = at_least_k(std::vector<set>{make({I(0, 1)})}, 0);
+    assert(everything.size() == 1 && everything.contains(-1e300) && everything.contains(1e300));
+  }
+
+  void histogram_splits_intervals_across_bins() {
+    auto const x = make({I(0.5, 3.25), I(5, 20)});
+    auto const h = histogram(x, 0.0, 1.0, 6);
+    double const expected[] = {0.5, 1, 1, 0.25, 0, 1};
+    for (std::size_t b = 0; b < h.size(); ++b) assert(h[b] == expected[b]);
+
+    std::vector<set> const sets{x, make({}), make({I(-10, 0.5)})};
+    auto const m = histograms(sets, 0.0, 1.0, 6);
+    assert(m.size() == 18);
+    for (std::size_t b = 0; b < 6; ++b) {
+      assert(m[b] == expected[b]);
+      assert(m[6 + b] == 0);
+      assert(m[12 + b] == (b == 0 ? 0.5 : 0));
+    }
+  }
+
+  void morphology() {
+    auto const x = make({I(0, 1), I(2, 3), I(10, 12)});
+    assert(same(dilate(x, 0.5), {I(-0.5, 3.5), I(9.5, 12.5)}));
+    assert(same(erode(x, 0.5), {I(0.5, 0.5), I(2.5, 2.5), I(10.5, 11.5)}));
+    assert(same(erode(x, 0.75), {I(10.75, 11.25)}));
+    assert(same(close_gaps(x, 1), {I(0, 3), I(10, 12)}));
+    assert(same(close_gaps(x, 7), {I(0, 12)}));
+
+    // a gap keeps the openness of the ends around it
+    auto const point = make({I(1, 2, false, true), I(2, 3, true, false)});
+    assert(same(close_gaps(point, 0), {I(1, 2, false, true), I(2, 3, true, false)}));
+    assert(same(close_gaps(point, 0.5), {I(1, 3)}));
+    auto const unit = make({I(0, 1, false, true), I(2, 3, true, false)});
+    assert(same(close_gaps(unit, 1), {I(0, 1, false, true), I(2, 3, true, false)}));
+    assert(same(close_gaps(make({I(0, 1, false, true), I(2, 3)}), 1), {I(0, 3)}));
+
+    bool threw = false;
+    try { dilate(x, -1); } catch (std::invalid_argument const &) { threw = true; }
+    assert(threw);
+    threw = false;
+    try { erode(x, -1); } catch (std::invalid_argument const &) { threw = true; }
+    assert(threw);
+  }
+
+  void shift_and_scale() {
+    auto x = make({I(0, 1, false, true), I(2, 3)});
+    shift(x, 10);
+    assert(same(x, {I(10, 11, false, true), I(12, 13)}));
+    scale(x, 2);
+    assert(same(x, {I(20, 22, false, true), I(24, 26)}));
+    scale(x, -1);
+    assert(same(x, {I(-26, -24), I(-22, -20, true, false)}));
+    scale(x, 0);
+    assert(same(x, {I(0, 0)}));
+  }
+
+  void snapping() {
+    auto const x = make({I(0.5, 1.5), I(1.75, 2, false, true), I(4, 4.5, true, false)});
+    assert(same(snap_outward(x, 1), {I(0, 2), I(4, 5, true, false)}));
+    assert(same(snap_inward(x, 1), {I(1, 1)}));
+    assert(snap_inward(make({I(0.25, 0.75)}), 1).empty());
+  }
+
+  void merge_is_a_boolean_operation() {
+    std::mt19937 g(2);
+    for (int round = 0; round < 300; ++round) {
+      auto const a = random_set(g), b = random_set(g);
+      std::vector<I> v;
+      disjoint_interval_set::merge_disjoint_interval_sets(
+        a.begin(), a.end(), b.begin(), b.end(),
+        [](bool x, bool y) { return x != y; },
+        [&v](I const & x) { v.push_back(x); });
+      auto const x = make(v);
+      assert(x.size() == v.size() && canonical(x));
+      for (auto p : probes()) assert(x.contains(p) == (a.contains(p) != b.contains(p)));
+      assert(x == (a ^ b));
+    }
+  }
+}
+
+int main() {
+  construction_coalesces();
+  operators_are_boolean_operations();
+  memory_usage_counts_the_buffer();
+  at_least_k_counts_coverage();
+  histogram_splits_intervals_across_bins();
+  morphology();
+  shift_and_scale();
+  snapping();
+  merge_is_a_boolean_operation();
+  std::puts("disjoint_interval_set_test: ok");
+}
@@ -0,0 +1,115 @@
+/**
+ * Tests of external_builder: sets built through runs on disk, with and
+ * without intermediate merges, equal the same sets built in memory, and
+ * the runs are cleaned up.
+ *
+ *   g++ -std=c++20 -Iinclude tests/external_construction_test.cpp -o external_construction_test
+ *   ./external_construction_test
+ */
+
+#include <disjoint_interval_set/external_construction.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <dirent.h>
+#include <unistd.h>
+
+using namespace disjoint_interval_set;
+
+namespace {
+  using I = interval<double>;
+  using set = ::disjoint_interval_set::disjoint_interval_set<I>;
+
+  std::string temp_dir() {
+    char const * t = std::getenv("TMPDIR");
+    std::string pattern = std::string(t ? t : "/tmp") + "/external_test-XXXXXX";
+    if (!::mkdtemp(pattern.data())) throw std::runtime_error("mkdtemp");
+    return pattern;
+  }
+
+  std::size_t entries(std::string const & dir) {
+    std::size_t n = 0;
+    auto * d = ::opendir(dir.c_str());
+    while (auto * e = ::readdir(d))
+      if (e->d_name[0] != '.') ++n;
+    ::closedir(d);
+    return n;
+  }
+
+  std::vector<I> random_input(std::mt19937 & g, std::size_t n, int span) {
+    std::uniform_int_distribution<int> pos(0, span), len(0, 50), coin(0, 1);
+    std::vector<I> v;
+    for (std::size_t k = 0; k < n; ++k) {
+      auto const l = pos(g);
+      v.emplace_back(l, l + len(g), coin(g) == 1, coin(g) == 1);
+    }
+    return v;
+  }
+
+  bool same(set const & x, set const & y) {
+    if (x.size() != y.size()) return false;
+    auto j = y.begin();
+    for (auto const & i : x) {
+      if (i.left != j->left || i.right != j->right ||
+          i.left_open != j->left_open || i.right_open != j->right_open)
+        return false;
+      ++j;
+    }
+    return true;
+  }
+
+  void matches_memory(std::string const & dir) {
+    std::mt19937 g(21);
+    // in memory, a few runs, and more runs than the fan-in of two pages
+    for (std::size_t budget : {std::size_t(1) << 24, std::size_t(4096) * sizeof(I), std::size_t(256) * sizeof(I)}) {
+      auto const in = random_input(g, 50000, 10000000);
+      external_builder<I> b(dir, budget, 2048);
+      b.push(in.begin(), in.end());
+      assert((b.runs() == 0) == (budget == (std::size_t(1) << 24)));
+      assert(same(b.to_set(), set(in)));
+    }
+    assert(entries(dir) == 0);
+  }
+
+  void coalesces_across_runs(std::string const & dir) {
+    // every interval overlaps the next, but they arrive shuffled
+    std::vector<I> in;
+    for (int k = 0; k < 20000; ++k) in.emplace_back(k, k + 1.5);
+    std::shuffle(in.begin(), in.end(), std::mt19937(22));
+    external_builder<I> b(dir, 512 * sizeof(I), 1024);
+    b.push(in.begin(), in.end());
+    assert(b.runs() > 1);
+    auto const s = b.to_set();
+    assert(s.size() == 1 && s.begin()->left == 0 && s.begin()->right == 20000.5);
+  }
+
+  void writes_a_file(std::string const & dir) {
+    std::mt19937 g(23);
+    auto const in = random_input(g, 20000, 1000000);
+    interval_file_writer<I> out(dir + "/out");
+    auto const n = make_disjoint_interval_set_external(in.begin(), in.end(), out, dir, 1024 * sizeof(I));
+    set const expected(in);
+    assert(n == expected.size());
+    paged_interval_set<I> const p(dir + "/out");
+    assert(p.size() == n);
+    auto j = expected.begin();
+    for (auto const & x : p) assert(x.left == j->left && x.right == (j++)->right);
+    ::unlink((dir + "/out").c_str());
+  }
+}
+
+int main() {
+  auto const dir = temp_dir();
+  matches_memory(dir);
+  coalesces_across_runs(dir);
+  writes_a_file(dir);
+  assert(entries(dir) == 0);
+  ::rmdir(dir.c_str());
+  std::puts("external_construction_test: ok");
+}
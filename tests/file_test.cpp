@@ -0,0 +1,158 @@
+/**
+ * Tests of the interval file format: the writer coalesces and pages its
+ * input, and readers reject files that are foreign, mistyped or corrupt.
+ *
+ *   g++ -std=c++20 -Iinclude tests/file_test.cpp -o file_test
+ *   ./file_test
+ */
+
+#include <disjoint_interval_set/disjoint_interval_set_file.hpp>
+#include <disjoint_interval_set/paged_interval_set.hpp>
+
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+using namespace disjoint_interval_set;
+
+namespace {
+  using I = interval<double>;
+
+  std::string temp_dir() {
+    char const * t = std::getenv("TMPDIR");
+    std::string pattern = std::string(t ? t : "/tmp") + "/file_test-XXXXXX";
+    if (!::mkdtemp(pattern.data())) throw std::runtime_error("mkdtemp");
+    return pattern;
+  }
+
+  std::vector<char> read_all(std::string const & path) {
+    std::ifstream f(path, std::ios::binary);
+    return std::vector<char>(std::istreambuf_iterator<char>(f), {});
+  }
+
+  void write_all(std::string const & path, std::vector<char> const & bytes) {
+    std::ofstream f(path, std::ios::binary | std::ios::trunc);
+    f.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+  }
+
+  template <typename J = I>
+  bool rejects(std::string const & path) {
+    try {
+      paged_interval_set<J> p(path);
+      for (auto const & x : p) (void)x;
+    } catch (std::runtime_error const &) {
+      return true;
+    }
+    return false;
+  }
+
+  void writes_canonical_pages(std::string const & dir) {
+    auto const path = dir + "/a";
+    interval_file_writer<I> w(path, 256);
+    // (256 - 8) / 17 = 14 records a page
+    for (int k = 0; k < 100; ++k) {
+      w.push(I(10.0 * k, 10.0 * k + 5));
+      w.push(I(10.0 * k + 5, 10.0 * k + 6, true, false)); // touches, fuses
+      w.push(I(10.0 * k + 8, 10.0 * k + 8, true, false));  // vacuous, dropped
+    }
+    assert(w.finish(true) == 100);
+
+    interval_file_header h;
+    auto const bytes = read_all(path);
+    std::memcpy(&h, bytes.data(), sizeof h);
+    assert(h.intervals == 100 && h.records_per_page == 14 && h.pages == 8);
+    assert(h.page_bytes == 256 && h.fences_offset == 9 * 256);
+    assert(bytes.size() == h.fences_offset + h.pages * sizeof(double));
+
+    paged_interval_set<I> const p(path);
+    std::size_t k = 0;
+    for (auto const & x : p) {
+      assert(x.left == 10.0 * k && x.right == 10.0 * k + 6 && !x.right_open);
+      ++k;
+    }
+    assert(k == 100);
+  }
+
+  void rejects_what_it_did_not_write(std::string const & dir) {
+    auto const path = dir + "/b";
+    {
+      interval_file_writer<I> w(path, 256);
+      for (int k = 0; k < 50; ++k) w.push(I(k, k + 0.5));
+      w.finish();
+    }
+    auto const good = read_all(path);
+    assert(!rejects(path));
+    assert(rejects<interval<float>>(path));
+    assert(rejects<interval<std::int64_t>>(path));
+
+    // every byte of the header, a record and the fences is checked
+    for (std::size_t at : {std::size_t(0), std::size_t(20), std::size_t(60),
+                           std::size_t(256 + 4), std::size_t(256 + 20), good.size() - 1}) {
+      auto bad = good;
+      bad[at] ^= 0x40;
+      write_all(path, bad);
+      assert(rejects(path));
+    }
+
+    // a page smaller than the header would put page 0 over it, even with
+    // a consistent checksum
+    {
+      auto bad = good;
+      interval_file_header h;
+      std::memcpy(&h, bad.data(), sizeof h);
+      h.page_bytes = 32;
+      h.records_per_page = 1;
+      h.header_crc = detail::crc32(&h, offsetof(interval_file_header, header_crc));
+      std::memcpy(bad.data(), &h, sizeof h);
+      write_all(path, bad);
+      assert(rejects(path));
+    }
+
+    write_all(path, std::vector<char>(good.begin(), good.begin() + 40));
+    assert(rejects(path));
+    write_all(path, std::vector<char>(100, 'x'));
+    assert(rejects(path));
+    assert(rejects(dir + "/missing"));
+  }
+
+  void empty_sets_and_tiny_pages(std::string const & dir) {
+    auto const path = dir + "/c";
+    interval_file_writer<I> w(path);
+    assert(w.finish() == 0);
+    paged_interval_set<I> const p(path);
+    assert(p.empty() && p.begin() == p.end() && !p.contains(0));
+
+    // a page must hold the 64-byte header; the file is not created
+    for (std::size_t bytes : {16, 32, 63}) {
+      bool threw = false;
+      try {
+        interval_file_writer<I> tiny(dir + "/d", bytes);
+      } catch (std::invalid_argument const &) {
+        threw = true;
+      }
+      assert(threw && ::access((dir + "/d").c_str(), F_OK) != 0);
+    }
+    interval_file_writer<I> smallest(dir + "/d", 64);
+    smallest.push(I(0, 1));
+    assert(smallest.finish() == 1);
+    assert(paged_interval_set<I>(dir + "/d").contains(0.5));
+  }
+}
+
+int main() {
+  auto const dir = temp_dir();
+  writes_canonical_pages(dir);
+  rejects_what_it_did_not_write(dir);
+  empty_sets_and_tiny_pages(dir);
+  for (auto f : {"a", "b", "c", "d"}) ::unlink((dir + "/" + f).c_str());
+  ::rmdir(dir.c_str());
+  std::puts("file_test: ok");
+}
@@ -0,0 +1,76 @@
+/**
+ * Tests of set fingerprints and std::hash of disjoint interval sets.
+ *
+ *   g++ -std=c++20 -Iinclude tests/hash_test.cpp -o hash_test
+ *   ./hash_test
+ */
+
+#include <disjoint_interval_set/disjoint_interval_set_hash.hpp>
+
+#include <cassert>
+#include <cstdio>
+#include <random>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+  using I = disjoint_interval_set::interval<double>;
+  using set = disjoint_interval_set::disjoint_interval_set<I>;
+
+  void equal_sets_have_equal_fingerprints() {
+    std::vector<I> const a{I(0, 1), I(2, 3)}, b{I(2, 3), I(0.5, 1), I(0, 0.75)};
+    set const x(a.begin(), a.end()), y(b.begin(), b.end());
+    assert(x == y);
+    assert(disjoint_interval_set::fingerprint(x) == disjoint_interval_set::fingerprint(y));
+    assert(std::hash<set>{}(x) == std::hash<set>{}(y));
+    assert(disjoint_interval_set::fingerprint(set()) == 0);
+  }
+
+  void openness_and_values_change_the_fingerprint() {
+    using disjoint_interval_set::fingerprint;
+    auto const f = [](I const & x) { return fingerprint(std::vector<I>{x}); };
+    assert(f(I(0, 1)) != f(I(0, 1, true, false)));
+    assert(f(I(0, 1)) != f(I(0, 1, false, true)));
+    assert(f(I(0, 1)) != f(I(0, 2)));
+  }
+
+  void fingerprints_are_additive() {
+    using disjoint_interval_set::fingerprint;
+    std::vector<I> const a{I(0, 1), I(2, 3), I(4, 5)};
+    auto const whole = fingerprint(a);
+    auto const parts = fingerprint(std::vector<I>{a[0]}) + fingerprint(std::vector<I>{a[1], a[2]});
+    assert(whole == parts);
+
+    // replacing one interval only needs its hash
+    std::vector<I> b = a;
+    b[1] = I(2, 3.5);
+    assert(fingerprint(b) == whole - fingerprint(std::vector<I>{a[1]}) +
+                             fingerprint(std::vector<I>{b[1]}));
+  }
+
+  void distinct_sets_rarely_collide() {
+    std::mt19937 g(4);
+    std::uniform_int_distribution<int> pos(0, 1000);
+    std::unordered_set<std::uint64_t> seen;
+    std::size_t distinct = 0;
+    std::unordered_set<set> sets;
+    for (int n = 0; n < 5000; ++n) {
+      auto const l = pos(g);
+      std::vector<I> const v{I(l, l + pos(g) % 10), I(l + 20, l + 21 + pos(g) % 10)};
+      set const x(v.begin(), v.end());
+      if (sets.insert(x).second) {
+        ++distinct;
+        seen.insert(disjoint_interval_set::fingerprint(x));
+      }
+    }
+    assert(seen.size() == distinct);
+  }
+}
+
+int main() {
+  equal_sets_have_equal_fingerprints();
+  openness_and_values_change_the_fingerprint();
+  fingerprints_are_additive();
+  distinct_sets_rarely_collide();
+  std::puts("hash_test: ok");
+}
@@ -0,0 +1,83 @@
+/**
+ * Tests of interval_index against a linear scan, including shared and
+ * open endpoints, and of its union.
+ *
+ *   g++ -std=c++20 -Iinclude tests/interval_index_test.cpp -o interval_index_test
+ *   ./interval_index_test
+ */
+
+#include <disjoint_interval_set/interval_index.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace disjoint_interval_set;
+
+namespace {
+  using I = interval<double>;
+
+  bool meets(I const & x, I const & q) { return !detail::vacuous(x * q); }
+
+  void agrees_with_a_scan() {
+    std::mt19937 g(15);
+    std::uniform_int_distribution<int> pos(0, 200), len(0, 20), coin(0, 1);
+    for (std::size_t n : {0, 1, 2, 7, 64, 65, 1000}) {
+      interval_index<I> x;
+      std::vector<I> v;
+      for (std::size_t k = 0; k < n; ++k) {
+        auto const l = pos(g);
+        v.emplace_back(l, l + len(g), coin(g) == 1, coin(g) == 1);
+        x.insert(v.back(), k);
+      }
+      x.build();
+      assert(x.built());
+
+      for (int round = 0; round < 300; ++round) {
+        auto const l = pos(g);
+        I const q(l, l + len(g) / 4, coin(g) == 1, coin(g) == 1);
+        auto got = x.overlapping(q);
+        std::sort(got.begin(), got.end());
+        std::vector<std::size_t> expected;
+        for (std::size_t k = 0; k < n; ++k)
+          if (!detail::vacuous(v[k]) && meets(v[k], q)) expected.push_back(k);
+        assert(got == expected);
+
+        std::size_t stabbed = 0;
+        x.stab(l, [&](auto const & e) { assert(e.interval.contains(l)); ++stabbed; });
+        assert(stabbed == static_cast<std::size_t>(std::count_if(v.begin(), v.end(),
+          [&](I const & i) { return !detail::vacuous(i) && i.contains(l); })));
+      }
+
+      auto const u = x.to_set();
+      for (int p = -2; p <= 450; ++p) {
+        auto const y = p / 2.0;
+        assert(u.contains(y) == std::any_of(v.begin(), v.end(),
+          [&](I const & i) { return !detail::vacuous(i) && i.contains(y); }));
+      }
+    }
+  }
+
+  void payloads_travel_with_their_intervals() {
+    interval_index<I, char const *> x;
+    x.insert(I(0, 10), "a");
+    x.insert(I(5, 6), "b");
+    x.insert(I(10, 20, true, false), "c");
+    x.insert(I(3, 3, true, false), "vacuous");
+    x.build();
+    assert(x.size() == 3);
+    auto const at10 = x.overlapping(I(10, 10));
+    assert(at10.size() == 1 && at10[0][0] == 'a');
+    auto const near = x.overlapping(I(5.5, 11));
+    assert(near.size() == 3);
+    assert(x.memory_usage().intervals == 3);
+  }
+}
+
+int main() {
+  agrees_with_a_scan();
+  payloads_travel_with_their_intervals();
+  std::puts("interval_index_test: ok");
+}
@@ -0,0 +1,66 @@
+/**
+ * Tests of interval<T>: intersection, subset order and membership.
+ *
+ *   g++ -std=c++20 -Iinclude tests/interval_test.cpp -o interval_test
+ *   ./interval_test
+ */
+
+#include <disjoint_interval_set/interval.hpp>
+
+#include <cassert>
+#include <cstdio>
+
+using namespace disjoint_interval_set;
+
+namespace {
+  using I = interval<double>;
+
+  bool same(I const & x, I const & y) {
+    return x.left == y.left && x.right == y.right &&
+           x.left_open == y.left_open && x.right_open == y.right_open;
+  }
+
+  // an endpoint shared by both operands is open in the intersection if it
+  // is open in either, since it must belong to both
+  void intersection_takes_the_open_shared_endpoint() {
+    assert(same(I(1, 2, false, true) * I(1, 2), I(1, 2, false, true)));
+    assert(same(I(1, 2) * I(1, 2, false, true), I(1, 2, false, true)));
+    assert(same(I(1, 2, true, false) * I(1, 2), I(1, 2, true, false)));
+    assert(same(I(1, 2) * I(1, 2, true, false), I(1, 2, true, false)));
+    assert(same(I(1, 2, true, true) * I(1, 2), I(1, 2, true, true)));
+    assert(same(I(1, 2) * I(1, 2), I(1, 2)));
+
+    auto const x = I(0, 2, false, true) * I(1, 2);
+    assert(!x.contains(2) && x.contains(1));
+  }
+
+  void intersection_of_distinct_endpoints() {
+    assert(same(I(0, 2) * I(1, 3, true, false), I(1, 2, true, false)));
+    assert(same(I(1, 3, false, true) * I(0, 2), I(1, 2)));
+    assert(empty(I(0, 1) * I(2, 3)));
+    assert(empty(I() * I(0, 1)));
+  }
+
+  void subset_order() {
+    assert(I(1, 2) < I(0, 3));
+    assert(I(1, 2, true, true) < I(1, 2));
+    assert(!(I(1, 2) < I(1, 2, true, false)));
+    assert(I() < I(0, 1));
+    assert(!(I(0, 1) < I()));
+  }
+
+  void membership() {
+    assert(contains(I(0, 1), 0.0) && contains(I(0, 1), 1.0));
+    assert(!contains(I(0, 1, true, true), 0.0) && !contains(I(0, 1, true, true), 1.0));
+    assert(*infimum(I(0, 1)) == 0 && *supremum(I(0, 1)) == 1);
+    assert(!infimum(I()) && !supremum(I()));
+  }
+}
+
+int main() {
+  intersection_takes_the_open_shared_endpoint();
+  intersection_of_distinct_endpoints();
+  subset_order();
+  membership();
+  std::puts("interval_test: ok");
+}
@@ -0,0 +1,110 @@
+/**
+ * Tests of learned_index: exact ranks on linear, clustered and infinite
+ * endpoints, whatever epsilon.
+ *
+ *   g++ -std=c++20 -Iinclude tests/learned_index_test.cpp -o learned_index_test
+ *   ./learned_index_test
+ */
+
+#include <disjoint_interval_set/learned_index.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace disjoint_interval_set;
+
+namespace {
+  using I = interval<double>;
+
+  std::size_t expected_rank(std::vector<I> const & v, double x) {
+    return static_cast<std::size_t>(std::upper_bound(v.begin(), v.end(), x,
+      [](double y, I const & i) { return y < i.left; }) - v.begin());
+  }
+
+  bool contains(std::vector<I> const & v, double x) {
+    auto const k = expected_rank(v, x);
+    return k != 0 && v[k - 1].contains(x);
+  }
+
+  void check(std::vector<I> const & v, std::size_t eps, std::mt19937_64 & g) {
+    learned_index<I> const li(v, eps);
+    assert(li.size() == v.size());
+    for (auto const & i : v) {
+      assert(li.rank(i.left) == expected_rank(v, i.left));
+      assert(li.locate(i.left) != li.end() || i.left_open);
+    }
+    std::uniform_real_distribution<double> x(v.front().left - 10, v.back().right + 10);
+    for (int k = 0; k < 20000; ++k) {
+      auto const q = x(g);
+      assert(li.rank(q) == expected_rank(v, q));
+      assert(li.contains(q) == contains(v, q));
+    }
+  }
+
+  void linear_endpoints_need_few_segments() {
+    std::vector<I> v;
+    for (int k = 0; k < 100000; ++k) v.emplace_back(10.0 * k, 10.0 * k + 5);
+    learned_index<I> const li(v, 16);
+    assert(li.segments().front() <= 2);
+    assert(li.memory_usage().heap_bytes < v.size() * sizeof(I) / 100);
+    std::mt19937_64 g(12);
+    check(v, 16, g);
+  }
+
+  void clustered_endpoints_stay_exact() {
+    std::mt19937_64 g(13);
+    std::exponential_distribution<double> gap(1);
+    std::vector<I> v;
+    double x = 0;
+    for (int k = 0; k < 50000; ++k) {
+      // bursts of tiny gaps between long jumps
+      x += (k % 1000 == 0) ? 1e6 : gap(g) * 1e-3;
+      v.emplace_back(x, x + 1e-4, k % 3 == 0, false);
+      x += 1e-4;
+    }
+    for (std::size_t eps : {1, 4, 64, 1024}) check(v, eps, g);
+  }
+
+  void infinite_endpoints() {
+    auto const inf = std::numeric_limits<double>::infinity();
+    std::vector<I> v{I(-inf, -5)};
+    for (int k = 0; k < 100000; ++k) v.emplace_back(10.0 * k, 10.0 * k + 5);
+    v.emplace_back(2e6, inf);
+    learned_index<I> const li(v, 16);
+    assert(li.contains(-inf) && li.contains(-1e300) && !li.contains(-1));
+    assert(li.contains(12) && !li.contains(17));
+    assert(li.contains(3e6) && li.contains(inf));
+    for (int k = 0; k < 100000; ++k) assert(li.rank(10.0 * k + 1) == static_cast<std::size_t>(k) + 2);
+
+    std::vector<I> const all{I(-inf, inf)};
+    assert(learned_index<I>(all).contains(0));
+  }
+
+  void empty_and_integral() {
+    std::vector<I> const none;
+    learned_index<I> const e(none);
+    assert(e.rank(1) == 0 && !e.contains(1) && e.locate(1) == e.end());
+
+    using J = interval<long>;
+    std::vector<J> v;
+    for (long k = 0; k < 10000; ++k) v.emplace_back(k * k, k * k + k);
+    learned_index<J> const li(v, 8);
+    for (long q = 0; q < 10000; ++q) {
+      auto const r = static_cast<long>(li.rank(q));
+      assert(r != 0 && (r - 1) * (r - 1) <= q && (r == 10000 || r * r > q));
+      assert(li.contains(q) == (q <= (r - 1) * (r - 1) + (r - 1)));
+    }
+  }
+}
+
+int main() {
+  linear_endpoints_need_few_segments();
+  clustered_endpoints_stay_exact();
+  infinite_endpoints();
+  empty_and_integral();
+  std::puts("learned_index_test: ok");
+}
@@ -0,0 +1,49 @@
+/**
+ * Tests of memory_footprint and the footprint of contiguous containers.
+ *
+ *   g++ -std=c++20 -Iinclude tests/memory_test.cpp -o memory_test
+ *   ./memory_test
+ */
+
+#include <disjoint_interval_set/disjoint_interval_set_memory.hpp>
+#include <disjoint_interval_set/interval.hpp>
+
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+using namespace disjoint_interval_set;
+
+namespace {
+  void padding_is_what_the_fields_leave() {
+    static_assert(interval_padding<interval<double>>() == sizeof(interval<double>) - 18);
+    static_assert(interval_padding<interval<std::int32_t>>() == sizeof(interval<std::int32_t>) - 10);
+  }
+
+  void contiguous_footprint_counts_capacity() {
+    using I = interval<double>;
+    std::vector<I> v;
+    v.reserve(10);
+    v.emplace_back(0, 1);
+    v.emplace_back(2, 3);
+    auto const m = contiguous_footprint(v);
+    assert(m.intervals == 2);
+    assert(m.heap_bytes == v.capacity() * sizeof(I));
+    assert(m.slack_bytes == (v.capacity() - 2) * sizeof(I));
+    assert(m.padding_bytes == 2 * interval_padding<I>());
+    assert(m.bytes_per_interval() == static_cast<double>(m.heap_bytes) / 2);
+  }
+
+  void empty_footprint() {
+    assert(memory_footprint().bytes_per_interval() == 0);
+    assert(contiguous_footprint(std::vector<interval<int>>()).heap_bytes == 0);
+  }
+}
+
+int main() {
+  padding_is_what_the_fields_leave();
+  contiguous_footprint_counts_capacity();
+  empty_footprint();
+  std::puts("memory_test: ok");
+}
@@ -0,0 +1,80 @@
+/**
+ * Tests of overlap_join against a nested loop, on one thread and on
+ * several, where every pair must still be reported exactly once.
+ *
+ *   g++ -std=c++20 -pthread -Iinclude tests/overlap_join_test.cpp -o overlap_join_test
+ *   ./overlap_join_test
+ */
+
+#include <disjoint_interval_set/overlap_join.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <mutex>
+#include <random>
+#include <utility>
+#include <vector>
+
+using namespace disjoint_interval_set;
+
+namespace {
+  using I = interval<double>;
+  using pairs = std::vector<std::pair<std::size_t, std::size_t>>;
+
+  std::vector<I> random_intervals(std::mt19937 & g, std::size_t n, int span, int longest) {
+    std::uniform_int_distribution<int> pos(0, span), len(0, longest), coin(0, 1);
+    std::vector<I> v;
+    for (std::size_t k = 0; k < n; ++k) {
+      auto const l = pos(g);
+      v.emplace_back(l, l + len(g), coin(g) == 1, coin(g) == 1);
+    }
+    return v;
+  }
+
+  pairs nested_loop(std::vector<I> const & a, std::vector<I> const & b) {
+    pairs out;
+    for (std::size_t i = 0; i < a.size(); ++i)
+      for (std::size_t j = 0; j < b.size(); ++j)
+        if (!detail::vacuous(a[i] * b[j])) out.emplace_back(i, j);
+    return out;
+  }
+
+  pairs join(std::vector<I> const & a, std::vector<I> const & b, unsigned threads) {
+    pairs out;
+    std::mutex m;
+    overlap_join(a, b, [&](std::size_t i, std::size_t j) {
+      std::lock_guard<std::mutex> lock(m);
+      out.emplace_back(i, j);
+    }, threads);
+    std::sort(out.begin(), out.end());
+    return out;
+  }
+
+  void agrees_with_a_nested_loop() {
+    std::mt19937 g(17);
+    for (std::size_t n : {0, 1, 10, 300, 2000}) {
+      for (int longest : {0, 5, 200}) {
+        auto const a = random_intervals(g, n, 1000, longest);
+        auto const b = random_intervals(g, n / 2 + 1, 1000, longest);
+        auto const expected = nested_loop(a, b);
+        for (unsigned threads : {1u, 2u, 3u, 8u}) assert(join(a, b, threads) == expected);
+      }
+    }
+  }
+
+  void long_intervals_span_partitions() {
+    std::vector<I> const a{I(0, 1e6)};
+    std::vector<I> b;
+    for (int k = 0; k < 1000; ++k) b.emplace_back(1000.0 * k, 1000.0 * k + 1);
+    auto const got = join(a, b, 8);
+    assert(got.size() == 1000);
+    assert(got == nested_loop(a, b));
+  }
+}
+
+int main() {
+  agrees_with_a_nested_loop();
+  long_intervals_span_partitions();
+  std::puts("overlap_join_test: ok");
+}
@@ -0,0 +1,120 @@
+/**
+ * Tests of paged_interval_set and the streaming set operations over files:
+ * lookups and the results agree with the same sets in memory, and the
+ * buffer cache stays within its pages.
+ *
+ *   g++ -std=c++20 -Iinclude tests/paged_interval_set_test.cpp -o paged_interval_set_test
+ *   ./paged_interval_set_test
+ */
+
+#include <disjoint_interval_set/disjoint_interval_set.hpp>
+#include <disjoint_interval_set/paged_interval_set.hpp>
+
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+using namespace disjoint_interval_set;
+
+namespace {
+  using I = interval<double>;
+  using set = ::disjoint_interval_set::disjoint_interval_set<I>;
+
+  std::string temp_dir() {
+    char const * t = std::getenv("TMPDIR");
+    std::string pattern = std::string(t ? t : "/tmp") + "/paged_test-XXXXXX";
+    if (!::mkdtemp(pattern.data())) throw std::runtime_error("mkdtemp");
+    return pattern;
+  }
+
+  set random_set(std::mt19937 & g, int n) {
+    std::uniform_int_distribution<int> pos(0, 10 * n), len(0, 12), coin(0, 1);
+    std::vector<I> v;
+    for (int k = 0; k < n; ++k) {
+      auto const l = pos(g);
+      v.emplace_back(l, l + len(g), coin(g) == 1, coin(g) == 1);
+    }
+    return set(v.begin(), v.end());
+  }
+
+  void write(set const & s, std::string const & path) {
+    interval_file_writer<I> w(path, 512);
+    w.push(s.begin(), s.end());
+    w.finish();
+  }
+
+  bool same(paged_interval_set<I> const & p, set const & s) {
+    if (p.size() != s.size()) return false;
+    auto j = s.begin();
+    for (auto const & i : p) {
+      if (i.left != j->left || i.right != j->right ||
+          i.left_open != j->left_open || i.right_open != j->right_open)
+        return false;
+      ++j;
+    }
+    return true;
+  }
+
+  void lookups_agree_with_memory(std::string const & dir) {
+    std::mt19937 g(19);
+    auto const s = random_set(g, 5000);
+    write(s, dir + "/a");
+    paged_interval_set<I> const p(dir + "/a", 4);
+    assert(same(p, s) && p.pages() > 4);
+
+    std::uniform_int_distribution<int> pos(-10, 50010), len(0, 40);
+    for (int k = 0; k < 5000; ++k) {
+      auto const v = pos(g) / 2.0;
+      assert(p.contains(v) == s.contains(v));
+    }
+    for (int k = 0; k < 300; ++k) {
+      auto const l = pos(g);
+      I const q(l, l + len(g), k % 2 == 0, k % 3 == 0);
+      auto const got = p.intersecting(q);
+      std::vector<I> expected;
+      for (auto const & i : s)
+        if (!detail::vacuous(i * q)) expected.push_back(i);
+      assert(got.size() == expected.size());
+      for (std::size_t m = 0; m < got.size(); ++m) assert(got[m].left == expected[m].left);
+    }
+
+    // four cached pages, no more
+    auto const stats = p.statistics();
+    assert(stats.hits != 0 && stats.misses != 0);
+    assert(p.memory_usage().intervals <= 4 * ((512 - 8) / 17));
+  }
+
+  void streaming_operations_agree_with_memory(std::string const & dir) {
+    std::mt19937 g(20);
+    for (int round = 0; round < 20; ++round) {
+      auto const a = random_set(g, 300), b = random_set(g, 300);
+      write(a, dir + "/a");
+      write(b, dir + "/b");
+      paged_interval_set<I> const pa(dir + "/a"), pb(dir + "/b");
+
+      auto check = [&](auto stream, set const & expected) {
+        interval_file_writer<I> out(dir + "/out", 512);
+        stream(pa, pb, out);
+        out.finish();
+        assert(same(paged_interval_set<I>(dir + "/out"), expected));
+      };
+      check([](auto const & x, auto const & y, auto & out) { paged_union(x, y, out); }, a + b);
+      check([](auto const & x, auto const & y, auto & out) { paged_intersection(x, y, out); }, a * b);
+      check([](auto const & x, auto const & y, auto & out) { paged_difference(x, y, out); }, a - b);
+    }
+  }
+}
+
+int main() {
+  auto const dir = temp_dir();
+  lookups_agree_with_memory(dir);
+  streaming_operations_agree_with_memory(dir);
+  for (auto f : {"a", "b", "out"}) ::unlink((dir + "/" + f).c_str());
+  ::rmdir(dir.c_str());
+  std::puts("paged_interval_set_test: ok");
+}
@@ -0,0 +1,101 @@
+/**
+ * Tests of the fast parser against the regex parser it replaces.
+ *
+ *   g++ -std=c++20 -Iinclude tests/parser_test.cpp -o parser_test
+ *   ./parser_test
+ */
+
+#include <disjoint_interval_set/disjoint_interval_set_parser.hpp>
+#include <disjoint_interval_set/interval.hpp>
+
+#include <cassert>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+  using I = disjoint_interval_set::interval<double>;
+
+  struct intervals : std::vector<I> {
+    using interval_type = I;
+  };
+
+  intervals slow(std::string const & s) {
+    intervals v;
+    disjoint_interval_set::make_interval_set(s, v);
+    return v;
+  }
+
+  intervals fast(std::string const & s) {
+    intervals v;
+    disjoint_interval_set::make_interval_set_fast(s, v);
+    return v;
+  }
+
+  bool same(intervals const & x, intervals const & y) {
+    if (x.size() != y.size()) return false;
+    for (std::size_t k = 0; k < x.size(); ++k)
+      if (x[k].left != y[k].left || x[k].right != y[k].right ||
+          x[k].left_open != y[k].left_open || x[k].right_open != y[k].right_open)
+        return false;
+    return true;
+  }
+
+  void parses_each_form() {
+    auto const inf = std::numeric_limits<double>::infinity();
+    auto const v = fast("[1,2) (3, inf] 7 ( -infinity , -1.5e1 ) [ +0.25 ,.5]");
+    assert(v.size() == 5);
+    assert(v[0].left == 1 && v[0].right == 2 && !v[0].left_open && v[0].right_open);
+    assert(v[1].left == 3 && v[1].right == inf && v[1].left_open && !v[1].right_open);
+    assert(v[2].left == 7 && v[2].right == 7 && !v[2].left_open && !v[2].right_open);
+    assert(v[3].left == -inf && v[3].right == -15 && v[3].left_open && v[3].right_open);
+    assert(v[4].left == 0.25 && v[4].right == 0.5);
+  }
+
+  void agrees_with_the_regex_parser() {
+    char const * const cases[] = {
+      "", "   ", "[1,2]", "(1,2)", "1 2 3", "[1,2] garbage [3,4)", "[-inf, +inf]",
+      "[1e3,2E-2]", "(0.5 ,  0.75]", ".5", "[1,2] [3,", "x[1,2]y",
+      // forms from_chars takes but the regex splits
+      "1.", "[1., 2]", "(0, 1.)", "1.e5", "[1.e5, 2]", "1e", "1e+", "[1e, 2]", "[2, 3e-]",
+    };
+    for (auto c : cases) assert(same(fast(c), slow(c)));
+  }
+
+  void agrees_on_a_random_corpus() {
+    std::mt19937 g(3);
+    std::uniform_real_distribution<double> x(-1e6, 1e6);
+    std::uniform_int_distribution<int> coin(0, 3);
+    std::string s;
+    for (int n = 0; n < 2000; ++n) {
+      auto const a = x(g), b = x(g);
+      switch (coin(g)) {
+        case 0: s += std::to_string(a); break;
+        case 1: s += "[" + std::to_string(a) + ", " + std::to_string(b) + ")"; break;
+        case 2: s += "(" + std::to_string(a) + ",inf]"; break;
+        default: s += "(-inf," + std::to_string(b) + ")"; break;
+      }
+      s += ' ';
+    }
+    auto const v = fast(s);
+    assert(v.size() == 2000);
+    assert(same(v, slow(s)));
+  }
+
+  void appends() {
+    intervals v;
+    disjoint_interval_set::make_interval_set_fast("[0,1]", v);
+    disjoint_interval_set::make_interval_set_fast("[2,3]", v);
+    assert(v.size() == 2 && v[1].left == 2);
+  }
+}
+
+int main() {
+  parses_each_form();
+  agrees_with_the_regex_parser();
+  agrees_on_a_random_corpus();
+  appends();
+  std::puts("parser_test: ok");
+}
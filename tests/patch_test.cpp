@@ -0,0 +1,112 @@
+/**
+ * Tests of diff, apply_patch and the binary form of patches.
+ *
+ *   g++ -std=c++20 -Iinclude tests/patch_test.cpp -o patch_test
+ *   ./patch_test
+ */
+
+#include <disjoint_interval_set/disjoint_interval_set_patch.hpp>
+
+#include <cassert>
+#include <cstdio>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+  using I = disjoint_interval_set::interval<double>;
+  using set = disjoint_interval_set::disjoint_interval_set<I>;
+
+  set random_set(std::mt19937 & g) {
+    std::uniform_int_distribution<int> pos(0, 60), len(0, 8), coin(0, 1), count(0, 8);
+    std::vector<I> v;
+    for (int n = count(g); n > 0; --n) {
+      auto const l = pos(g);
+      v.emplace_back(l, l + len(g), coin(g) == 1, coin(g) == 1);
+    }
+    return set(v.begin(), v.end());
+  }
+
+  bool same(std::vector<I> const & x, std::vector<I> const & y) {
+    if (x.size() != y.size()) return false;
+    for (std::size_t k = 0; k < x.size(); ++k)
+      if (x[k].left != y[k].left || x[k].right != y[k].right ||
+          x[k].left_open != y[k].left_open || x[k].right_open != y[k].right_open)
+        return false;
+    return true;
+  }
+
+  bool same(set const & x, set const & y) {
+    return same(std::vector<I>(x.begin(), x.end()), std::vector<I>(y.begin(), y.end()));
+  }
+
+  void apply_turns_old_into_new() {
+    std::mt19937 g(5);
+    for (int round = 0; round < 500; ++round) {
+      auto const a = random_set(g), b = random_set(g);
+      auto const p = disjoint_interval_set::diff(a, b);
+      assert(same(apply_patch(a, p), b));
+      assert(same(apply_patch(b, p.inverse()), a));
+      assert(p.empty() == (a == b));
+      // the two halves never overlap
+      for (auto const & x : p.added)
+        for (auto const & y : p.removed) assert(disjoint_interval_set::detail::vacuous(x * y));
+    }
+  }
+
+  void small_changes_give_small_patches() {
+    std::vector<I> v;
+    for (int k = 0; k < 1000; ++k) v.emplace_back(2 * k, 2 * k + 1);
+    set const a(v.begin(), v.end());
+    v[500] = I(1000, 1000.5);
+    set const b(v.begin(), v.end());
+    auto const p = disjoint_interval_set::diff(a, b);
+    assert(p.added.empty() && p.removed.size() == 1);
+    assert(p.removed[0].left == 1000.5 && p.removed[0].left_open && p.removed[0].right == 1001);
+  }
+
+  void round_trips_through_bytes() {
+    std::mt19937 g(6);
+    auto const p = disjoint_interval_set::diff(random_set(g), random_set(g));
+    auto const bytes = disjoint_interval_set::serialize_patch(p);
+    auto const q = disjoint_interval_set::deserialize_patch<I>(bytes.data(), bytes.size());
+    assert(same(p.added, q.added) && same(p.removed, q.removed));
+  }
+
+  bool rejects(std::vector<char> const & bytes) {
+    try {
+      disjoint_interval_set::deserialize_patch<I>(bytes.data(), bytes.size());
+    } catch (std::runtime_error const &) {
+      return true;
+    }
+    return false;
+  }
+
+  void rejects_damaged_bytes() {
+    disjoint_interval_set::interval_patch<I> p;
+    p.added = {I(0, 1), I(2, 3)};
+    p.removed = {I(5, 6)};
+    auto const bytes = disjoint_interval_set::serialize_patch(p);
+
+    assert(rejects(std::vector<char>(bytes.begin(), bytes.begin() + 20)));
+    assert(rejects(std::vector<char>(bytes.begin(), bytes.end() - 1)));
+    for (std::size_t k = 0; k < bytes.size(); k += 7) {
+      auto damaged = bytes;
+      damaged[k] ^= 0x10;
+      assert(rejects(damaged));
+    }
+
+    // a patch of floats is not one of doubles
+    disjoint_interval_set::interval_patch<disjoint_interval_set::interval<float>> f;
+    f.added = {disjoint_interval_set::interval<float>(0, 1)};
+    assert(rejects(disjoint_interval_set::serialize_patch(f)));
+  }
+}
+
+int main() {
+  apply_turns_old_into_new();
+  small_changes_give_small_patches();
+  round_trips_through_bytes();
+  rejects_damaged_bytes();
+  std::puts("patch_test: ok");
+}
@@ -0,0 +1,88 @@
+/**
+ * Tests of range_filter: no false negatives, few false positives in the
+ * gaps of skewed sets, and infinite, integral and empty sets.
+ *
+ *   g++ -std=c++20 -Iinclude tests/range_filter_test.cpp -o range_filter_test
+ *   ./range_filter_test
+ */
+
+#include <disjoint_interval_set/disjoint_interval_set.hpp>
+#include <disjoint_interval_set/range_filter.hpp>
+
+#include <cassert>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace disjoint_interval_set;
+
+namespace {
+  using I = interval<double>;
+  using set = ::disjoint_interval_set::disjoint_interval_set<I>;
+
+  // a dense cluster of intervals and one outlier far away, which would
+  // leave a uniform grid with a single bucket for the whole cluster
+  set skewed(std::mt19937_64 & g) {
+    std::uniform_real_distribution<double> step(0.1, 1);
+    std::vector<I> v;
+    double x = 0;
+    for (int k = 0; k < 100000; ++k) {
+      auto const l = x + step(g);
+      x = l + step(g);
+      v.emplace_back(l, x);
+    }
+    v.emplace_back(1e9, 1e9 + 1);
+    return set(v);
+  }
+
+  void never_rejects_a_member() {
+    std::mt19937_64 g(10);
+    auto const s = skewed(g);
+    range_filter<I> const f(s);
+    for (auto const & i : s) {
+      assert(f.may_contain(i.left) && f.may_contain(i.right));
+      assert(f.may_contain((i.left + i.right) / 2));
+      assert(f.may_intersect(i));
+      assert(f.may_intersect(I(i.left - 0.01, i.left)));
+    }
+  }
+
+  void rejects_most_of_the_gaps() {
+    std::mt19937_64 g(11);
+    auto const s = skewed(g);
+    range_filter<I> const f(s, 16);
+    std::vector<I> const v(s.begin(), s.end());
+    std::size_t passed = 0, probes = 0;
+    for (std::size_t k = 0; k + 2 < v.size(); ++k) {
+      auto const a = v[k].right, b = v[k + 1].left;
+      for (int t = 1; t < 4; ++t, ++probes) passed += f.may_contain(a + (b - a) * t / 4);
+    }
+    auto const rate = static_cast<double>(passed) / static_cast<double>(probes);
+    assert(rate < 0.1);
+    assert(f.false_positive_bound() <= 0.2);
+    assert(!f.may_contain(5e8) && !f.may_intersect(I(2e8, 3e8)));
+    assert(f.memory_usage().heap_bytes < 2 * s.size() * 16 / 8);
+  }
+
+  void infinite_integral_and_empty_sets() {
+    auto const inf = std::numeric_limits<double>::infinity();
+    range_filter<I> const f(set(std::vector<I>{I(-inf, 0), I(5, 6)}));
+    assert(f.may_contain(-1e300) && f.may_contain(-inf) && f.may_contain(0) && f.may_contain(5.5));
+    assert(!f.may_contain(7) && !f.may_contain(inf));
+
+    using J = interval<int>;
+    range_filter<J> const fi(::disjoint_interval_set::disjoint_interval_set<J>(std::vector<J>{J(1, 1)}));
+    assert(fi.may_contain(1) && !fi.may_contain(2) && !fi.may_contain(0));
+
+    range_filter<I> const fe{set()};
+    assert(!fe.may_contain(0) && !fe.may_intersect(I(-inf, inf)));
+  }
+}
+
+int main() {
+  never_rejects_a_member();
+  rejects_most_of_the_gaps();
+  infinite_integral_and_empty_sets();
+  std::puts("range_filter_test: ok");
+}
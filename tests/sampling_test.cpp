@@ -0,0 +1,108 @@
+/**
+ * Tests of length-weighted uniform sampling from a set.
+ *
+ *   g++ -std=c++20 -Iinclude tests/sampling_test.cpp -o sampling_test
+ *   ./sampling_test
+ */
+
+#include <disjoint_interval_set/disjoint_interval_set_sampling.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <climits>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace {
+  template <typename T>
+  using set = disjoint_interval_set::disjoint_interval_set<disjoint_interval_set::interval<T>>;
+
+  void samples_lie_in_the_set_in_order() {
+    using I = disjoint_interval_set::interval<double>;
+    std::vector<I> const v{I(0, 1), I(10, 13), I(20, 20), I(30, 36, true, true)};
+    set<double> const s(v.begin(), v.end());
+    std::mt19937 g(7);
+    auto const xs = sample(s, g, 100000);
+    assert(xs.size() == 100000);
+    assert(std::is_sorted(xs.begin(), xs.end()));
+    for (auto x : xs) assert(s.contains(x));
+
+    // each interval is hit in proportion to its length, 1 : 3 : 0 : 6
+    std::size_t hits[4] = {};
+    for (auto x : xs) ++hits[x < 5 ? 0 : x < 15 ? 1 : x < 25 ? 2 : 3];
+    assert(hits[2] == 0);
+    assert(std::abs(hits[0] / 1e5 - 0.1) < 0.01);
+    assert(std::abs(hits[1] / 1e5 - 0.3) < 0.01);
+    assert(std::abs(hits[3] / 1e5 - 0.6) < 0.01);
+
+    disjoint_interval_set::interval_sampler<I> const one(s);
+    assert(one.measure() == 10);
+    for (int k = 0; k < 1000; ++k) assert(s.contains(one(g)));
+  }
+
+  void integers_are_counted_not_measured() {
+    using I = disjoint_interval_set::interval<int>;
+    std::vector<I> const v{I(0, 0), I(5, 9, true, false), I(20, 21, true, true)};
+    set<int> const s(v.begin(), v.end());
+    disjoint_interval_set::interval_sampler<I> const sampler(s);
+    assert(sampler.measure() == 5);
+
+    std::mt19937 g(8);
+    std::size_t hits[10] = {};
+    for (auto x : sampler(g, 50000)) {
+      assert(x == 0 || (x >= 6 && x <= 9));
+      ++hits[x];
+    }
+    for (auto x : {0, 6, 7, 8, 9}) assert(std::abs(hits[x] / 5e4 - 0.2) < 0.01);
+  }
+
+  void open_endpoints_are_never_drawn() {
+    using I = disjoint_interval_set::interval<double>;
+    // near 1e16 doubles are 2 apart, so most offsets round onto an endpoint
+    double const b = 1e16;
+    std::vector<I> const v{I(0, 1, true, true), I(b, b + 4, true, true), I(b + 8, b + 12, true, false),
+                           I(b + 16, b + 20, false, true)};
+    set<double> const s(v.begin(), v.end());
+    disjoint_interval_set::interval_sampler<I> const sampler(s);
+    std::mt19937 g(10);
+    for (auto p : sampler(g, 20000)) assert(s.contains(p));
+    for (int k = 0; k < 20000; ++k) assert(s.contains(sampler(g)));
+
+    // an open interval between adjacent doubles holds nothing
+    std::vector<I> const empty{I(1, std::nextafter(1.0, 2.0), true, true)};
+    disjoint_interval_set::interval_sampler<I> const none(set<double>(empty.begin(), empty.end()));
+    assert(none.measure() == 0 && none(g, 10).empty());
+  }
+
+  void the_whole_of_int_is_counted() {
+    using I = disjoint_interval_set::interval<int>;
+    std::vector<I> const v{I(INT_MIN, INT_MAX)};
+    set<int> const s(v.begin(), v.end());
+    disjoint_interval_set::interval_sampler<I> const sampler(s);
+    assert(sampler.measure() == std::uint64_t(1) << 32);
+
+    std::mt19937 g(11);
+    auto const xs = sampler(g, 1000);
+    assert(xs.size() == 1000 && std::is_sorted(xs.begin(), xs.end()));
+    assert(xs.front() < -(1 << 30) && xs.back() > (1 << 30));
+  }
+
+  void nothing_to_draw_from() {
+    std::mt19937 g(9);
+    assert(sample(set<double>(), g, 10).empty());
+    using I = disjoint_interval_set::interval<double>;
+    std::vector<I> const point{I(1, 1)};
+    assert(sample(set<double>(point.begin(), point.end()), g, 10).empty());
+  }
+}
+
+int main() {
+  samples_lie_in_the_set_in_order();
+  integers_are_counted_not_measured();
+  open_endpoints_are_never_drawn();
+  the_whole_of_int_is_counted();
+  nothing_to_draw_from();
+  std::puts("sampling_test: ok");
+}
@@ -0,0 +1,96 @@
+/**
+ * Tests of stabbing_index against asking every set in turn, and of its
+ * space on long overlapping intervals.
+ *
+ *   g++ -std=c++20 -Iinclude tests/stabbing_index_test.cpp -o stabbing_index_test
+ *   ./stabbing_index_test
+ */
+
+#include <disjoint_interval_set/disjoint_interval_set.hpp>
+#include <disjoint_interval_set/stabbing_index.hpp>
+
+#include <cassert>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace disjoint_interval_set;
+
+namespace {
+  using I = interval<double>;
+  using set = ::disjoint_interval_set::disjoint_interval_set<I>;
+  using id = stabbing_index<I>::id_type;
+
+  set random_set(std::mt19937 & g) {
+    std::uniform_int_distribution<int> pos(0, 60), len(0, 6), coin(0, 1), count(0, 5);
+    std::vector<I> v;
+    for (int n = count(g); n > 0; --n) {
+      auto const l = pos(g);
+      v.emplace_back(l, l + len(g), coin(g) == 1, coin(g) == 1);
+    }
+    return set(v.begin(), v.end());
+  }
+
+  bool intersects(set const & s, I const & q) {
+    for (auto const & i : s)
+      if (!detail::vacuous(i * q)) return true;
+    return false;
+  }
+
+  void agrees_with_every_set() {
+    std::mt19937 g(16);
+    std::uniform_int_distribution<int> pos(-4, 140), len(0, 20), coin(0, 1);
+    for (int round = 0; round < 50; ++round) {
+      std::vector<set> sets(static_cast<std::size_t>(round));
+      for (auto & s : sets) s = random_set(g);
+      stabbing_index<I> const x(sets);
+
+      for (int p = -4; p <= 140; ++p) {
+        auto const v = p / 2.0;
+        auto const got = x.stab(v);
+        std::vector<id> expected;
+        for (std::size_t k = 0; k < sets.size(); ++k)
+          if (sets[k].contains(v)) expected.push_back(static_cast<id>(k));
+        assert(std::vector<id>(got.begin(), got.end()) == expected);
+      }
+
+      for (int t = 0; t < 200; ++t) {
+        auto const l = pos(g) / 2.0;
+        I const q(l, l + len(g) / 2.0, coin(g) == 1, coin(g) == 1);
+        std::vector<id> expected;
+        for (std::size_t k = 0; k < sets.size(); ++k)
+          if (!detail::vacuous(q) && intersects(sets[k], q)) expected.push_back(static_cast<id>(k));
+        assert(x.intersecting(q) == expected);
+      }
+    }
+  }
+
+  void atoms_are_cut_at_distinct_endpoints() {
+    std::vector<set> const sets{set(std::vector<I>{I(0, 1), I(2, 3)}), set(std::vector<I>{I(1, 2)})};
+    stabbing_index<I> const x(sets);
+    assert(x.atoms() == 9);
+    assert(x.stab(1).size() == 2 && x.stab(1.5).size() == 1 && x.stab(1.5)[0] == 1);
+    assert(x.stab(-1).empty() && x.stab(4).empty());
+    assert(x.memory_usage().heap_bytes != 0);
+  }
+
+  void long_intervals_are_not_copied_to_every_atom() {
+    // 1000 sets, each one interval over 2000 of the 6000 atoms and a point:
+    // one posting per atom spanned would be 2 million ids
+    std::vector<set> sets;
+    for (int k = 0; k < 1000; ++k)
+      sets.push_back(set(std::vector<I>{I(k, k + 1000), I(5000 + k, 5000 + k)}));
+    stabbing_index<I> const x(sets);
+    assert(x.memory_usage().heap_bytes < 1000000);
+    assert(x.stab(999.5).size() == 1000 && x.stab(500).size() == 501);
+    assert(x.intersecting(I(1500, 6000)).size() == 1000);
+    assert(x.intersecting(I(5001.5, 5003.5)) == (std::vector<id>{2, 3}));
+  }
+}
+
+int main() {
+  agrees_with_every_set();
+  atoms_are_cut_at_distinct_endpoints();
+  long_intervals_are_not_copied_to_every_atom();
+  std::puts("stabbing_index_test: ok");
+}
@@ -0,0 +1,112 @@
+/**
+ * Tests of the trace hooks: every phase is bracketed by a begin and an end
+ * event carrying the input and the output size.
+ *
+ *   g++ -std=c++20 -Iinclude tests/trace_test.cpp -o trace_test
+ *   ./trace_test
+ */
+
+#define DISJOINT_INTERVAL_SET_TRACE
+
+#include <disjoint_interval_set/disjoint_interval_set.hpp>
+#include <disjoint_interval_set/disjoint_interval_set_parser.hpp>
+
+#include <cassert>
+#include <cstdio>
+#include <vector>
+
+using namespace disjoint_interval_set;
+
+namespace {
+  using I = interval<double>;
+
+  struct event {
+    trace_phase phase;
+    trace_event kind;
+    std::size_t n;
+  };
+
+  std::vector<event> events;
+
+  struct intervals : std::vector<I> {
+    using interval_type = I;
+  };
+
+  void record(trace_phase phase, trace_event kind, std::size_t n) {
+    events.push_back(event{phase, kind, n});
+  }
+
+  bool saw(trace_phase phase, trace_event kind, std::size_t n) {
+    for (auto const & e : events)
+      if (e.phase == phase && e.kind == kind && e.n == n) return true;
+    return false;
+  }
+
+  // begin and end events nest like brackets
+  bool balanced() {
+    std::vector<trace_phase> open;
+    for (auto const & e : events) {
+      if (e.kind == trace_event::begin) {
+        open.push_back(e.phase);
+      } else {
+        if (open.empty() || open.back() != e.phase) return false;
+        open.pop_back();
+      }
+    }
+    return open.empty();
+  }
+
+  void construction_traces_sort_and_coalesce() {
+    events.clear();
+    std::vector<I> const v{I(0, 2), I(1, 3), I(5, 6)};
+    ::disjoint_interval_set::disjoint_interval_set<I> const x(v.begin(), v.end());
+    assert(x.size() == 2);
+    assert(saw(trace_phase::sort, trace_event::begin, 3));
+    assert(saw(trace_phase::coalesce, trace_event::begin, 3));
+    assert(saw(trace_phase::coalesce, trace_event::end, 2));
+    assert(balanced());
+  }
+
+  void union_traces_the_copy() {
+    std::vector<I> const a{I(0, 1)}, b{I(2, 3), I(4, 5)};
+    ::disjoint_interval_set::disjoint_interval_set<I> const x(a.begin(), a.end()), y(b.begin(), b.end());
+    events.clear();
+    auto const u = x + y;
+    assert(u.size() == 3);
+    assert(saw(trace_phase::allocate, trace_event::begin, 3));
+    assert(saw(trace_phase::allocate, trace_event::end, 3));
+    assert(balanced());
+
+    events.clear();
+    auto const c = ~x;
+    assert(c.size() == 2);
+    assert(saw(trace_phase::complement, trace_event::begin, 1));
+    assert(balanced());
+  }
+
+  void parse_reports_bytes_in_and_intervals_out() {
+    intervals v;
+    events.clear();
+    make_interval_set("[0,1] 2", v);
+    assert(saw(trace_phase::parse, trace_event::begin, 7));
+    assert(saw(trace_phase::parse, trace_event::end, 2));
+    assert(balanced());
+  }
+
+  void hooks_can_be_removed() {
+    assert(set_trace_hook(nullptr) == &record);
+    events.clear();
+    std::vector<I> const v{I(0, 1)};
+    ::disjoint_interval_set::disjoint_interval_set<I> const x(v.begin(), v.end());
+    assert(events.empty());
+  }
+}
+
+int main() {
+  assert(set_trace_hook(&record) == nullptr);
+  construction_traces_sort_and_coalesce();
+  union_traces_the_copy();
+  parse_reports_bytes_in_and_intervals_out();
+  hooks_can_be_removed();
+  std::puts("trace_test: ok");
+}
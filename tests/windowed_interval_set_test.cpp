@@ -0,0 +1,119 @@
+/**
+ * Tests of windowed_interval_set against the union of everything
+ * inserted, clipped to the window, and of the empty and unbounded
+ * intervals that must not move it.
+ *
+ *   g++ -std=c++20 -Iinclude tests/windowed_interval_set_test.cpp -o windowed_interval_set_test
+ *   ./windowed_interval_set_test
+ */
+
+#include <disjoint_interval_set/windowed_interval_set.hpp>
+
+#include <cassert>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace disjoint_interval_set;
+
+namespace {
+  using I = interval<double>;
+  using set = ::disjoint_interval_set::disjoint_interval_set<I>;
+
+  bool same(windowed_interval_set<I> const & w, set const & s) {
+    if (w.size() != s.size()) return false;
+    auto j = s.begin();
+    for (auto const & i : w) {
+      if (i.left != j->left || i.right != j->right ||
+          i.left_open != j->left_open || i.right_open != j->right_open)
+        return false;
+      ++j;
+    }
+    return true;
+  }
+
+  // everything inserted, cut to the window (now - width, +inf)
+  set reference(std::vector<I> const & all, double now, double width) {
+    std::vector<I> v;
+    for (auto const & x : all) {
+      auto y = x;
+      if (y.left < now - width || (y.left == now - width && !y.left_open))
+        y = I(now - width, y.right, true, y.right_open);
+      if (!detail::vacuous(y)) v.push_back(y);
+    }
+    return set(v.begin(), v.end());
+  }
+
+  void agrees_with_a_reference() {
+    std::mt19937 g(18);
+    std::uniform_int_distribution<int> late(-30, 3), len(0, 8), coin(0, 1), tick(0, 4);
+    for (int round = 0; round < 50; ++round) {
+      double const width = 10 + round % 20;
+      windowed_interval_set<I> w(width);
+      std::vector<I> all;
+      double t = 0;
+      for (int op = 0; op < 400; ++op) {
+        if (op % 7 == 6) {
+          t += tick(g);
+          w.advance(t);
+        } else {
+          // mostly in order, sometimes late
+          auto const l = t + late(g);
+          all.emplace_back(l, l + len(g), coin(g) == 1, coin(g) == 1);
+          w.insert(all.back());
+          if (!detail::vacuous(all.back())) t = std::max(t, all.back().right);
+        }
+        assert(w.now() == t);
+        auto const r = reference(all, w.now(), width);
+        assert(same(w, r));
+        assert(w.fingerprint() == fingerprint(r));
+        assert(w.to_set() == r);
+        for (int p = -4; p <= 8; ++p) {
+          auto const v = w.now() - p * width / 4;
+          assert(w.contains(v) == r.contains(v));
+        }
+      }
+    }
+  }
+
+  void the_window_slides() {
+    windowed_interval_set<I> w(10);
+    w.insert(I(0, 5));
+    w.insert(I(6, 8));
+    assert(w.size() == 2 && w.now() == 8 && w.horizon() == -2);
+    w.advance(13);
+    assert(w.size() == 2 && w.begin()->left == 3 && w.begin()->left_open);
+    assert(!w.contains(3) && w.contains(4));
+    w.advance(18);
+    assert(w.size() == 0 && w.empty() && w.fingerprint() == 0);
+    w.advance(1);
+    assert(w.now() == 18);
+    w.insert(I(0, 7));
+    assert(w.empty());
+  }
+
+  void empty_and_unbounded_intervals() {
+    windowed_interval_set<I> w(10);
+    w.insert(I(0, 5));
+    // an empty interval far ahead does not slide the window
+    w.insert(I(100, 100, true, false));
+    w.insert(I(200, 150));
+    assert(w.now() == 5 && w.size() == 1);
+
+    // nor does one reaching to infinity; it stays as the window moves on
+    auto const inf = std::numeric_limits<double>::infinity();
+    w.insert(I(3, inf, false, true));
+    assert(w.now() == 5 && w.size() == 1 && w.contains(0) && w.contains(1e300));
+    w.advance(20);
+    assert(w.size() == 1 && w.begin()->left == 10 && w.begin()->left_open);
+    assert(w.contains(11) && w.contains(1e300) && w.fingerprint() == fingerprint(w.to_set()));
+  }
+}
+
+int main() {
+  agrees_with_a_reference();
+  the_window_slides();
+  empty_and_unbounded_intervals();
+  std::puts("windowed_interval_set_test: ok");
+}